@@ -51,6 +51,11 @@ typedef int Id;
 %nodefaultctor libdnf::ModuleProfile;
 %nodefaultctor libdnf::ModuleDependencies;
 
+// internal helpers of modular filtering
+%ignore libdnf::ModulePackage::ArtifactId;
+%ignore libdnf::ModulePackage::getArtifactIds;
+%ignore libdnf::ModulePackageContainer::getModularFilterPackages;
+
 %include "libdnf/module/ModulePackage.hpp"
 %ignore libdnf::ModulePackageContainer::Exception;
 %ignore libdnf::ModulePackageContainer::NoModuleException;
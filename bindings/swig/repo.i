@@ -21,6 +21,7 @@
 
 // make SWIG look into following headers
 %template(VectorPPackageTarget) std::vector<libdnf::PackageTarget *>;
+%template(VectorPRepo) std::vector<libdnf::Repo *>;
 
 %extend libdnf::Repo {
     Repo(const std::string & id, ConfigRepo * config)
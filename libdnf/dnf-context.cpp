@@ -3276,8 +3276,9 @@ static std::vector<std::tuple<libdnf::ModulePackageContainer::ModuleErrorType, s
 static std::pair<std::unique_ptr<libdnf::Nsvcap>, std::vector< libdnf::ModulePackage*>> resolve_module_spec(const std::string & module_spec, libdnf::ModulePackageContainer & container)
 {
     std::unique_ptr<libdnf::Nsvcap> nsvcapObj(new libdnf::Nsvcap);
+    libdnf::Nsvcap::Forms specForms(module_spec.c_str());
     for (std::size_t i = 0; HY_MODULE_FORMS_MOST_SPEC[i] != _HY_MODULE_FORM_STOP_; ++i) {
-        if (nsvcapObj->parse(module_spec.c_str(), HY_MODULE_FORMS_MOST_SPEC[i])) {
+        if (nsvcapObj->parse(specForms, HY_MODULE_FORMS_MOST_SPEC[i])) {
             auto result_modules = container.query(nsvcapObj->getName(),
                                                   nsvcapObj->getStream(),
                                                   nsvcapObj->getVersion(),
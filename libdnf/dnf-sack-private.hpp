@@ -29,6 +29,9 @@
 #include "hy-query.h"
 #include "sack/packageset.hpp"
 #include "sack/query.hpp"
+#include "sack/querycache.hpp"
+#include "sack/updownindex.hpp"
+#include "goal/SolvedGoal.hpp"
 #include "module/ModulePackage.hpp"
 #include "module/ModulePackageContainer.hpp"
 
@@ -70,6 +73,44 @@ Id           dnf_sack_last_solvable         (DnfSack    *sack);
 const char * dnf_sack_get_arch              (DnfSack    *sack);
 void         dnf_sack_set_provides_not_ready(DnfSack    *sack);
 void         dnf_sack_set_considered_to_update(DnfSack * sack);
+
+/**
+ * @brief Returns cache of query results or nullptr when it is disabled
+ */
+libdnf::QueryCache * dnf_sack_get_query_cache(DnfSack *sack);
+
+/**
+ * @brief Returns cache of goal solutions or nullptr when it is disabled
+ */
+libdnf::SolveCache * dnf_sack_get_solve_cache(DnfSack *sack);
+
+/**
+ * @brief Returns live shared packages of the sack indexed by their Id, see dnf_package_new_shared()
+ */
+std::vector<DnfPackage *> & dnf_sack_get_shared_packages(DnfSack *sack);
+
+/**
+ * @brief Returns map of packages providing any of the installonly provides
+ *
+ * The map is rebuilt lazily when the sack generation or the installonly provides change.
+ */
+const Map *  dnf_sack_get_installonly_map   (DnfSack    *sack);
+
+/**
+ * @brief Returns installed packages upgraded and downgraded by available packages
+ *
+ * The index is rebuilt lazily when the sack generation changes.
+ */
+const libdnf::UpdownIndex & dnf_sack_get_updown_index(DnfSack *sack);
+
+/**
+ * @brief Returns number which changes whenever results of queries may change
+ */
+guint64      dnf_sack_get_generation        (DnfSack    *sack);
+/**
+ * @brief Returns number identifying the sack, unlike its address it is never reused by another sack
+ */
+guint64      dnf_sack_get_serial            (DnfSack    *sack);
 Queue       *dnf_sack_get_installonly       (DnfSack    *sack);
 void         dnf_sack_set_running_kernel_fn (DnfSack    *sack,
                                              dnf_sack_running_kernel_fn_t fn);
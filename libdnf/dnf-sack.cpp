@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <errno.h>
 #include <functional>
 #include <unistd.h>
@@ -65,6 +66,7 @@ extern "C" {
 #include "dnf-types.h"
 #include "dnf-package.h"
 #include "hy-iutil-private.hpp"
+#include "hy-package-private.hpp"
 #include "hy-query.h"
 #include "hy-repo-private.hpp"
 #include "dnf-sack-private.hpp"
@@ -73,6 +75,8 @@ extern "C" {
 #include "utils/bgettext/bgettext-lib.h"
 
 #include "sack/query.hpp"
+#include "sack/querycache.hpp"
+#include "goal/SolvedGoal.hpp"
 #include "nevra.hpp"
 #include "conf/ConfigParser.hpp"
 #include "conf/OptionBool.hpp"
@@ -112,11 +116,28 @@ typedef struct
     dnf_sack_running_kernel_fn_t  running_kernel_fn;
     guint                installonly_limit;
     libdnf::ModulePackageContainer * moduleContainer;
+    guint64              generation;        /* Changes whenever query results may change */
+    guint64              serial;            /* Unlike the address, never reused by another sack */
+    libdnf::QueryCache  *query_cache;
+    libdnf::SolveCache  *solve_cache;
+    libdnf::UpdownIndex *updown_index;
+    guint64              updown_generation; /* Generation the updown_index was built for */
+    Map                 *installonly_map;   /* Packages providing an installonly provide */
+    guint64              installonly_generation;
+    std::vector<DnfPackage *> *shared_packages; /* Live shared packages indexed by Id */
 } DnfSackPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfSack, dnf_sack, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (static_cast<DnfSackPrivate *>(dnf_sack_get_instance_private (o)))
 
+static void
+dnf_sack_set_considered_outdated(DnfSackPrivate *priv)
+{
+    priv->considered_uptodate = FALSE;
+    /* cached query results were computed with the old considered packages */
+    ++priv->generation;
+}
+
 
 /**
  * dnf_sack_finalize:
@@ -147,6 +168,17 @@ dnf_sack_finalize(GObject *object)
     free_map_fully(priv->module_includes);
     free_map_fully(pool->considered);
     free_map_fully(priv->pkg_solvables);
+    free_map_fully(priv->installonly_map);
+    if (priv->shared_packages) {
+        // the packages may outlive the sack
+        for (auto pkg : *priv->shared_packages)
+            if (pkg)
+                dnf_package_unshare(pkg);
+        delete priv->shared_packages;
+    }
+    delete priv->query_cache;
+    delete priv->solve_cache;
+    delete priv->updown_index;
     pool_free(priv->pool);
     if (priv->moduleContainer) {
         delete priv->moduleContainer;
@@ -182,7 +214,9 @@ log_cb(Pool *pool, void *cb_data, int level, const char *buf)
 static void
 dnf_sack_init(DnfSack *sack)
 {
+    static std::atomic<guint64> lastSerial{0};
     DnfSackPrivate *priv = GET_PRIVATE(sack);
+    priv->serial = ++lastSerial;
     priv->pool = pool_create();
     pool_set_flag(priv->pool, POOL_FLAG_WHATPROVIDESWITHDISABLED, 1);
     priv->running_kernel_id = -1;
@@ -1178,6 +1212,7 @@ dnf_sack_set_installonly(DnfSack *sack, const char **installonly)
     const char *name;
 
     queue_empty(&priv->installonly);
+    priv->installonly_map = free_map_fully(priv->installonly_map);
     if (installonly == NULL)
         return;
     while ((name = *installonly++) != NULL)
@@ -1269,7 +1304,7 @@ dnf_sack_add_cmdline_package_flags(DnfSack *sack, const char *fn, const int flag
     }
     auto hrepo = static_cast<HyRepo>(repo->appdata);
     libdnf::repoGetImpl(hrepo)->needs_internalizing = 1;
-    priv->considered_uptodate = FALSE;   /* triggers recompute_considered later */
+    dnf_sack_set_considered_outdated(priv);   /* triggers recompute_considered later */
     return dnf_package_new(sack, p);
 }
 
@@ -1335,7 +1370,7 @@ dnf_sack_add_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet
     auto pkgmap = pkgset->getMap();
     map_or(destmap, pkgmap);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
 }
 
 /**
@@ -1394,7 +1429,7 @@ dnf_sack_remove_excludes_or_includes(DnfSack *sack, Map *from, const DnfPackageS
     auto pkgmap = pkgset->getMap();
     map_subtract(from, pkgmap);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
 }
 
 /**
@@ -1458,7 +1493,7 @@ dnf_sack_set_excludes_or_includes(DnfSack *sack, Map **dest, const DnfPackageSet
         map_init_clone(*dest, pkgmap);
     }
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
 }
 
 void
@@ -1654,7 +1689,7 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
         if (hyrepo->getUseIncludes() != enabled)
         {
             hyrepo->setUseIncludes(enabled);
-            priv->considered_uptodate = FALSE;
+            dnf_sack_set_considered_outdated(priv);
         }
     } else {
         Id repoid;
@@ -1664,7 +1699,7 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
             if (hyrepo->getUseIncludes() != enabled)
             {
                 hyrepo->setUseIncludes(enabled);
-                priv->considered_uptodate = FALSE;
+                dnf_sack_set_considered_outdated(priv);
             }
         }
     }
@@ -1698,7 +1733,161 @@ void
 dnf_sack_set_considered_to_update(DnfSack *sack)
 {
     DnfSackPrivate *priv = GET_PRIVATE(sack);
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
+}
+
+/**
+ * dnf_sack_set_query_cache_size:
+ * @sack: a #DnfSack instance.
+ * @size: maximal number of cached query results, 0 disables the cache.
+ *
+ * Enables caching of results of applied queries. Results are dropped when
+ * repositories are loaded, excludes or includes are changed or when
+ * dnf_sack_set_considered_to_update() is called. It has to be called also
+ * after changing repository attributes that affect queries, like priority.
+ *
+ * Since: 0.73.0
+ */
+void
+dnf_sack_set_query_cache_size(DnfSack *sack, guint size)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (size == 0) {
+        delete priv->query_cache;
+        priv->query_cache = NULL;
+    } else if (priv->query_cache) {
+        priv->query_cache->setCapacity(size);
+    } else {
+        priv->query_cache = new libdnf::QueryCache(size);
+    }
+}
+
+/**
+ * dnf_sack_get_query_cache_size:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: maximal number of cached query results, 0 if the cache is disabled
+ *
+ * Since: 0.73.0
+ */
+guint
+dnf_sack_get_query_cache_size(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->query_cache ? priv->query_cache->getCapacity() : 0;
+}
+
+/**
+ * dnf_sack_set_solve_cache_size:
+ * @sack: a #DnfSack instance.
+ * @size: maximal number of cached goal solutions, 0 disables the cache.
+ *
+ * Enables caching of goal solutions. A goal resolved with the same job and
+ * settings as a cached one takes the cached solution without running the
+ * solver. Solutions are dropped under the same conditions as query results,
+ * see dnf_sack_set_query_cache_size().
+ *
+ * Since: 0.73.0
+ */
+void
+dnf_sack_set_solve_cache_size(DnfSack *sack, guint size)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (size == 0) {
+        delete priv->solve_cache;
+        priv->solve_cache = NULL;
+    } else if (priv->solve_cache) {
+        priv->solve_cache->setCapacity(size);
+    } else {
+        priv->solve_cache = new libdnf::SolveCache(size);
+    }
+}
+
+/**
+ * dnf_sack_get_solve_cache_size:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: maximal number of cached goal solutions, 0 if the cache is disabled
+ *
+ * Since: 0.73.0
+ */
+guint
+dnf_sack_get_solve_cache_size(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->solve_cache ? priv->solve_cache->getCapacity() : 0;
+}
+
+libdnf::SolveCache *
+dnf_sack_get_solve_cache(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->solve_cache;
+}
+
+libdnf::QueryCache *
+dnf_sack_get_query_cache(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->query_cache;
+}
+
+std::vector<DnfPackage *> &
+dnf_sack_get_shared_packages(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->shared_packages)
+        priv->shared_packages = new std::vector<DnfPackage *>;
+    return *priv->shared_packages;
+}
+
+const Map *
+dnf_sack_get_installonly_map(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    if (priv->installonly_map && priv->installonly_generation == priv->generation &&
+        priv->installonly_map->size == ((pool->nsolvables + 7) >> 3))
+        return priv->installonly_map;
+
+    dnf_sack_make_provides_ready(sack);
+    free_map_fully(priv->installonly_map);
+    priv->installonly_map = static_cast<Map *>(g_malloc0(sizeof(Map)));
+    map_init(priv->installonly_map, pool->nsolvables);
+    for (int i = 0; i < priv->installonly.count; ++i) {
+        Id p, pp;
+        FOR_PKG_PROVIDES(p, pp, priv->installonly.elements[i])
+            MAPSET(priv->installonly_map, p);
+    }
+    priv->installonly_generation = priv->generation;
+    return priv->installonly_map;
+}
+
+const libdnf::UpdownIndex &
+dnf_sack_get_updown_index(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->updown_index || priv->updown_generation != priv->generation ||
+        priv->updown_index->getNSolvables() != priv->pool->nsolvables) {
+        delete priv->updown_index;
+        priv->updown_index = new libdnf::UpdownIndex(priv->pool);
+        priv->updown_generation = priv->generation;
+    }
+    return *priv->updown_index;
+}
+
+guint64
+dnf_sack_get_generation(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->generation;
+}
+
+guint64
+dnf_sack_get_serial(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->serial;
 }
 
 /**
@@ -1762,7 +1951,7 @@ dnf_sack_repo_enabled(DnfSack *sack, const char *reponame, int enabled)
     else
         FOR_REPO_SOLVABLES(repo, p, s)
             MAPCLR(priv->repo_excludes, p);
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
     return 0;
 }
 
@@ -1822,7 +2011,7 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     repoImpl->main_nsolvables = repo->nsolvables;
     repoImpl->main_nrepodata = repo->nrepodata;
     repoImpl->main_end = repo->end;
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
 
  finish:
     if (a_hrepo == NULL)
@@ -1948,7 +2137,7 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error) try
             if (!write_ext(sack, repo, _HY_REPODATA_UPDATEINFO, HY_EXT_UPDATEINFO, error))
                 return FALSE;
     }
-    priv->considered_uptodate = FALSE;
+    dnf_sack_set_considered_outdated(priv);
     return TRUE;
 } CATCH_TO_GERROR(FALSE)
 
@@ -2384,119 +2573,14 @@ void readModuleMetadataFromRepo(DnfSack * sack, libdnf::ModulePackageContainer *
     }
 }
 
-/// @return std::map<name:stream.arch, std::vector<std::string>>
-static std::map<std::string, std::vector<std::string>> getDemodularizedRpms(
-    libdnf::ModulePackageContainer & moduleContainer, const std::vector<libdnf::ModulePackage *> & allPackages)
-{
-    std::map<std::string, std::vector<std::string>> ret;
-    auto latest = moduleContainer.getLatestModules(allPackages, true);
-    for (auto modulePackage : latest) {
-        auto demodularized = modulePackage->getDemodularizedRpms();
-        if (demodularized.empty()) {
-            continue;
-        }
-        std::string packageID{modulePackage->getNameStream()};
-        packageID.append(".");
-        packageID.append(modulePackage->getArch());
-        auto & data = ret[packageID];
-        data.insert(data.end(), demodularized.begin(), demodularized.end());
-    }
-    return ret;
-}
-
-/// Return <includeNEVRAs>, <excludeNEVRAs>, <names>, <srcNames>, <name dependency container>
-static std::tuple<std::vector<std::string>, std::vector<std::string>, std::vector<std::string>, std::vector<std::string>, libdnf::DependencyContainer>
-collectNevraForInclusionExclusion(DnfSack *sack, libdnf::ModulePackageContainer &modulePackageContainer)
-{
-    auto allPackages = modulePackageContainer.getModulePackages();
-    auto demodularizedNames = getDemodularizedRpms(modulePackageContainer, allPackages);
-
-    std::vector<std::string> includeNEVRAs;
-    std::vector<std::string> excludeNEVRAs;
-    std::vector<std::string> names;
-    std::vector<std::string> srcNames;
-    libdnf::DependencyContainer nameDependencies{sack};
-    libdnf::Nevra nevra;
-    // TODO: turn into std::vector<const char *> to prevent unnecessary conversion?
-    for (const auto & module : allPackages) {
-        auto artifacts = module->getArtifacts();
-        // TODO use Goal::listInstalls() to not requires filtering out Platform
-        if (modulePackageContainer.isModuleActive(module->getId())) {
-            std::string packageID{module->getNameStream()};
-            packageID.append(".");
-            packageID.append(module->getArch());
-            auto it = demodularizedNames.find(packageID);
-            if (it == demodularizedNames.end()) {
-                for (const auto &rpm : artifacts) {
-                    if (nevra.parse(rpm.c_str(), HY_FORM_NEVRA)) {
-                        auto arch = nevra.getArch();
-                        // source packages do not provide anything and must not cause excluding binary packages
-                        if (arch == "src" || arch == "nosrc") {
-                            srcNames.push_back(nevra.getName());
-                        } else {
-                            names.push_back(nevra.getName());
-                            nameDependencies.addReldep(nevra.getName().c_str());
-                        }
-                    }
-                }
-            } else {
-                for (const auto &rpm : artifacts) {
-                    if (nevra.parse(rpm.c_str(), HY_FORM_NEVRA)) {
-                        bool found = false;
-                        for ( auto & demodularized : it->second) {
-                            if (nevra.getName() == demodularized) {
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (found) {
-                            continue;
-                        }
-                        auto arch = nevra.getArch();
-                        // source packages do not provide anything and must not cause excluding binary packages
-                        if (arch == "src" || arch == "nosrc") {
-                            srcNames.push_back(nevra.getName());
-                        } else {
-                            names.push_back(nevra.getName());
-                            nameDependencies.addReldep(nevra.getName().c_str());
-                        }
-                    }
-                }
-            }
-            copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(includeNEVRAs));
-        } else {
-            copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(excludeNEVRAs));
-        }
-    }
-
-    return std::make_tuple(std::move(includeNEVRAs), std::move(excludeNEVRAs), std::move(names), std::move(srcNames),
-                           std::move(nameDependencies));
-}
-
 void
 setModuleExcludes(DnfSack * sack, const char ** hotfixRepos, libdnf::ModulePackageContainer & modulePackageContainer)
 {
     dnf_sack_set_module_excludes(sack, nullptr);
 
-    auto data = collectNevraForInclusionExclusion(sack, modulePackageContainer);
-
-    auto & includeNEVRAs = std::get<0>(data);
-    auto & excludeNEVRAs = std::get<1>(data);
-    auto & names = std::get<2>(data);
-    auto & srcNames = std::get<3>(data);
-    auto & nameDependencies = std::get<4>(data);
-
-    std::vector<const char *> namesCString(names.size() + 1);
-    std::vector<const char *> srcNamesCString(srcNames.size() + 1);
-    std::vector<const char *> excludeNEVRAsCString(excludeNEVRAs.size() + 1);
-    std::vector<const char *> includeNEVRAsCString(includeNEVRAs.size() + 1);
-
-    transform(names.begin(), names.end(), namesCString.begin(), std::mem_fn(&std::string::c_str));
-    transform(srcNames.begin(), srcNames.end(), srcNamesCString.begin(), std::mem_fn(&std::string::c_str));
-    transform(excludeNEVRAs.begin(), excludeNEVRAs.end(), excludeNEVRAsCString.begin(),
-              std::mem_fn(&std::string::c_str));
-    transform(includeNEVRAs.begin(), includeNEVRAs.end(), includeNEVRAsCString.begin(),
-              std::mem_fn(&std::string::c_str));
+    libdnf::PackageSet includes(sack);
+    libdnf::PackageSet excludes(sack);
+    modulePackageContainer.getModularFilterPackages(sack, includes, excludes);
 
     libdnf::Query keepPackages{sack};
     const char *keepRepo[] = {HY_CMDLINE_REPO_NAME, HY_SYSTEM_REPO_NAME, nullptr};
@@ -2507,31 +2591,11 @@ setModuleExcludes(DnfSack * sack, const char ** hotfixRepos, libdnf::ModulePacka
 
     libdnf::Query includeQuery{sack};
     libdnf::Query excludeQuery{keepPackages};
-    libdnf::Query excludeProvidesQuery{keepPackages};
-    libdnf::Query excludeNamesQuery(keepPackages);
-    libdnf::Query excludeSrcNamesQuery(keepPackages);
-    includeQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, includeNEVRAsCString.data());
-
-    excludeQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, excludeNEVRAsCString.data());
+    includeQuery.addFilter(HY_PKG, HY_EQ, &includes);
+    excludeQuery.addFilter(HY_PKG, HY_EQ, &excludes);
     excludeQuery.queryDifference(includeQuery);
 
-    // Exclude packages by their Provides
-    excludeProvidesQuery.addFilter(HY_PKG_PROVIDES, &nameDependencies);
-    excludeProvidesQuery.queryDifference(includeQuery);
-
-    // Search for source packages with same names as included source artifacts
-    excludeSrcNamesQuery.addFilter(HY_PKG_NAME, HY_EQ, srcNamesCString.data());
-    const char * srcArchs[] = {"src", "nosrc", nullptr};
-    excludeSrcNamesQuery.addFilter(HY_PKG_ARCH, HY_EQ, srcArchs);
-
-    // Required to filtrate out source packages and packages with incompatible architectures
-    excludeNamesQuery.addFilter(HY_PKG_NAME, HY_EQ, namesCString.data());
-    excludeNamesQuery.queryUnion(excludeSrcNamesQuery);
-    excludeNamesQuery.queryDifference(includeQuery);
-
     dnf_sack_set_module_excludes(sack, excludeQuery.getResultPset());
-    dnf_sack_add_module_excludes(sack, excludeProvidesQuery.getResultPset());
-    dnf_sack_add_module_excludes(sack, excludeNamesQuery.getResultPset());
     dnf_sack_set_module_includes(sack, includeQuery.getResultPset());
 }
 
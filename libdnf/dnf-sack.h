@@ -118,6 +118,12 @@ void         dnf_sack_set_installonly       (DnfSack        *sack,
 void         dnf_sack_set_installonly_limit (DnfSack        *sack,
                                              guint           limit);
 guint        dnf_sack_get_installonly_limit (DnfSack        *sack);
+void         dnf_sack_set_query_cache_size  (DnfSack        *sack,
+                                             guint           size);
+guint        dnf_sack_get_query_cache_size  (DnfSack        *sack);
+void         dnf_sack_set_solve_cache_size  (DnfSack        *sack,
+                                             guint           size);
+guint        dnf_sack_get_solve_cache_size  (DnfSack        *sack);
 DnfPackage  *dnf_sack_add_cmdline_package   (DnfSack        *sack,
                                              const char     *fn);
 DnfPackage  *dnf_sack_add_cmdline_package_nochecksum(DnfSack *sack,
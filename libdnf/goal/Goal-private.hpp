@@ -23,8 +23,13 @@
 
 #include "Goal.hpp"
 #include "IdQueue.hpp"
+#include "SolvedGoal.hpp"
 #include "../sack/packageset.hpp"
 
+#include <map>
+#include <unordered_map>
+#include <vector>
+
 namespace libdnf {
 
 class Goal::Impl {
@@ -40,13 +45,34 @@ private:
     Queue staging;
     PackageSet exclude_from_weak;
     Solver *solv{nullptr};
+    /// Number of solvables, the installed repo of the pool and the generation of the sack when solv
+    /// was created. Package rules kept by solv are valid only for the considered packages of that
+    /// generation.
+    int solverNsolvables{0};
+    ::Repo *solverInstalled{nullptr};
+    guint64 solverGeneration{0};
     ::Transaction *trans{nullptr};
+    /// When set, solv and trans are owned by it and shared with the solve cache of the sack
+    std::shared_ptr<SolvedGoal> solved;
     DnfGoalActions actions{DNF_NONE};
     std::unique_ptr<PackageSet> protectedPkgs;
     bool protect_running_kernel{true};
     std::unique_ptr<PackageSet> removalOfProtected;
+    /// Transaction steps by their type, filled by classifyTransaction()
+    std::unique_ptr<std::map<Id, PackageSet>> stepsByType;
+    /// Transaction steps of the OBSOLETED type when active steps are not shown
+    std::unique_ptr<PackageSet> obsoletedSteps;
+    /// Memoized results of transaction_all_obs_pkgs()
+    std::unordered_map<Id, std::vector<Id>> obsoletedByPackage;
+    /// Statistics of the last run, rule and decision counts are taken from the solver on demand
+    int solvePasses{0};
+    std::map<std::string, double> phaseTimes;
 
     PackageSet listResults(Id type_filter1, Id type_filter2);
+    void classifyTransaction();
+    void resetTransaction();
+    void releaseSolver();
+    std::string getSolveSignature(const Queue *job, DnfGoalActions flags);
     void allowUninstallAllButProtected(Queue *job, DnfGoalActions flags);
     std::unique_ptr<IdQueue> constructJob(DnfGoalActions flags);
     bool solve(Queue *job, DnfGoalActions flags);
@@ -18,10 +18,13 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <map>
 #include <vector>
 #include <numeric>
+#include <unordered_map>
 
 extern "C" {
 #include <solv/evr.h>
@@ -68,6 +71,23 @@ std::string moduleSolvid2str(Pool * pool, Id source)
     return ss.str();
 }
 
+/// Adds wall time of its lifetime to a phase of the goal statistics
+class PhaseTimer {
+public:
+    PhaseTimer(std::map<std::string, double> & phaseTimes, const char * phase)
+    : phaseTimes(phaseTimes), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer()
+    {
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        phaseTimes[phase] += time.count();
+    }
+
+private:
+    std::map<std::string, double> & phaseTimes;
+    const char * phase;
+    std::chrono::steady_clock::time_point start;
+};
+
 }
 
 namespace libdnf {
@@ -677,10 +697,7 @@ Goal::~Goal() = default;
 
 Goal::Impl::~Impl()
 {
-    if (trans)
-        transaction_free(trans);
-    if (solv)
-        solver_free(solv);
+    releaseSolver();
     queue_free(&staging);
 }
 
@@ -830,6 +847,40 @@ Goal::reset_exclude_from_weak()
     pImpl->exclude_from_weak.clear();
 }
 
+/// Returns true for rich dependencies like "(a if b)"
+static bool
+isRichDependency(Pool * pool, Id dep)
+{
+    if (!ISRELDEP(dep)) {
+        return false;
+    }
+    switch (GETRELDEP(pool, dep)->flags) {
+        case REL_AND:
+        case REL_OR:
+        case REL_WITH:
+        case REL_WITHOUT:
+        case REL_COND:
+        case REL_UNLESS:
+        case REL_ELSE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Appends non-rich dependencies of the given type of the solvable to deps
+static void
+appendNonRichDependencies(Pool * pool, Solvable * s, Id type, IdQueue & deps)
+{
+    IdQueue solvableDeps;
+    solvable_lookup_deparray(s, type, solvableDeps.getQueue(), -1);
+    for (int i = 0; i < solvableDeps.size(); ++i) {
+        if (!isRichDependency(pool, solvableDeps[i])) {
+            deps.pushBack(solvableDeps[i]);
+        }
+    }
+}
+
 void
 Goal::exclude_from_weak_autodetect()
 {
@@ -840,76 +891,92 @@ Goal::exclude_from_weak_autodetect()
     }
     Query base_query(pImpl->sack);
     base_query.apply();
+    Pool * pool = dnf_sack_get_pool(pImpl->sack);
+    dnf_sack_make_provides_ready(pImpl->sack);
     auto * installed_pset = installed_query.getResultPset();
+    auto * base_pset = base_query.getResultPset();
+    const Map * installed = installed_pset->getMap();
+    const Map * base = base_pset->getMap();
+    PackageSet exclude(pImpl->sack);
+    Id p, pp;
+
+    // Collect recommends of installed packages and names of installed packages
+    Map installed_names;
+    map_init(&installed_names, pool->ss.nstrings);
+    IdQueue recommends;
     Id installed_id = -1;
-
-    std::vector<const char *> installed_names;
-    installed_names.reserve(installed_pset->size() + 1);
-
-    // Iterate over installed packages to detect unmet weak deps
     while ((installed_id = installed_pset->next(installed_id)) != -1) {
-        g_autoptr(DnfPackage) pkg = dnf_package_new(pImpl->sack, installed_id);
-        installed_names.push_back(dnf_package_get_name(pkg));
-        std::unique_ptr<libdnf::DependencyContainer> recommends(dnf_package_get_recommends(pkg));
-        for (int i = 0; i < recommends->count(); ++i) {
-            std::unique_ptr<libdnf::Dependency> dep(recommends->getPtr(i));
-            const char * dep_string = dep->toString();
-            if (dep_string[0] == '(') {
-                continue;
-            }
-            Query query(base_query);
-            const char * version = dep->getVersion();
-            //  There can be installed provider in different version or upgraded packed can recommend a different version
-            //  Ignore version and search only by reldep name
-            if (version && strlen(version) > 0) {
-                query.addFilter(HY_PKG_PROVIDES, HY_EQ, dep->getName());
-            } else {
-                query.addFilter(HY_PKG_PROVIDES, dep.get());
+        Solvable * s = pool_id2solvable(pool, installed_id);
+        MAPSET(&installed_names, s->name);
+        appendNonRichDependencies(pool, s, SOLVABLE_RECOMMENDS, recommends);
+    }
+
+    // Many installed packages share recommends, resolve each of them once
+    std::sort(recommends.data(), recommends.data() + recommends.size());
+    auto recommends_end = std::unique(recommends.data(), recommends.data() + recommends.size());
+    for (auto it = recommends.data(); it != recommends_end; ++it) {
+        Id dep = *it;
+        //  There can be installed provider in different version or upgraded packed can recommend a different version
+        //  Ignore version and search only by reldep name
+        if (ISRELDEP(dep) && pool_id2evr(pool, dep)[0] != '\0') {
+            while (ISRELDEP(dep)) {
+                dep = GETRELDEP(pool, dep)->name;
             }
-            // No providers of recommend => continue
-            if (query.empty()) {
+        }
+        bool provided = false;
+        bool provided_by_installed = false;
+        FOR_PROVIDES(p, pp, dep) {
+            if (!MAPTST(base, p)) {
                 continue;
             }
-            Query test_installed(query);
-            test_installed.installed();
-            // when there is not installed any provider of recommend, exclude it
-            if (test_installed.empty()) {
-                add_exclude_from_weak(*query.getResultPset());
+            provided = true;
+            if (pool_id2solvable(pool, p)->repo == pool->installed) {
+                provided_by_installed = true;
+                break;
+            }
+        }
+        // when there is not installed any provider of recommend, exclude it
+        if (provided && !provided_by_installed) {
+            FOR_PROVIDES(p, pp, dep) {
+                if (MAPTST(base, p)) {
+                    exclude.set(p);
+                }
             }
         }
     }
 
     // Investigate supplements of only available packages with a different name to installed packages
-    installed_names.push_back(nullptr);
-    base_query.addFilter(HY_PKG_NAME, HY_NEQ, installed_names.data());
-    auto * available_pset = base_query.getResultPset();
-    *available_pset -= *installed_pset;
+    // Supplements shared by available packages are resolved once, supplemented_cache holds
+    // whether the supplement has an installed provider
+    std::unordered_map<Id, bool> supplemented_cache;
+    IdQueue supplements;
     Id available_id = -1;
-    while ((available_id = available_pset->next(available_id)) != -1) {
-        g_autoptr(DnfPackage) pkg = dnf_package_new(pImpl->sack, available_id);
-        std::unique_ptr<libdnf::DependencyContainer> supplements(dnf_package_get_supplements(pkg));
-        if (supplements->count() == 0) {
+    while ((available_id = base_pset->next(available_id)) != -1) {
+        Solvable * s = pool_id2solvable(pool, available_id);
+        if (MAPTST(installed, available_id) || MAPTST(&installed_names, s->name)) {
             continue;
         }
-        libdnf::DependencyContainer supplements_without_rich(getSack());
-        for (int i = 0; i < supplements->count(); ++i) {
-            std::unique_ptr<libdnf::Dependency> dep(supplements->getPtr(i));
-            const char * dep_string = dep->toString();
-            if (dep_string[0] == '(') {
-                continue;
+        supplements.clear();
+        appendNonRichDependencies(pool, s, SOLVABLE_SUPPLEMENTS, supplements);
+        for (int i = 0; i < supplements.size(); ++i) {
+            auto cached = supplemented_cache.emplace(supplements[i], false);
+            if (cached.second) {
+                FOR_PROVIDES(p, pp, supplements[i]) {
+                    if (MAPTST(installed, p)) {
+                        cached.first->second = true;
+                        break;
+                    }
+                }
+            }
+            // When supplemented package already installed, exclude_from_weak available package
+            if (cached.first->second) {
+                exclude.set(available_id);
+                break;
             }
-            supplements_without_rich.add(dep.get());
-        }
-        if (supplements_without_rich.count() == 0) {
-            continue;
-        }
-        Query query(installed_query);
-        query.addFilter(HY_PKG_PROVIDES, &supplements_without_rich);
-        // When supplemented package already installed, exclude_from_weak available package
-        if (!query.empty()) {
-            add_exclude_from_weak(pkg);
         }
     }
+    map_free(&installed_names);
+    add_exclude_from_weak(exclude);
 }
 
 void
@@ -987,12 +1054,94 @@ Goal::jobLength()
 bool
 Goal::run(DnfGoalActions flags)
 {
-    auto job = pImpl->constructJob(flags);
+    pImpl->solvePasses = 0;
+    pImpl->phaseTimes.clear();
+    std::unique_ptr<IdQueue> job;
+    {
+        PhaseTimer timer(pImpl->phaseTimes, "job");
+        job = pImpl->constructJob(flags);
+    }
     pImpl->actions = static_cast<DnfGoalActions>(pImpl->actions | flags);
     int ret = pImpl->solve(job->getQueue(), flags);
     return ret;
 }
 
+int
+Goal::runWithFallbacks(const std::vector<DnfGoalActions> & strategies)
+{
+    // Strategies are tried one after another on the goal's solver. libsolv creates whatprovides
+    // entries of dependencies lazily while solving, so a pool cannot be shared by solvers running
+    // concurrently.
+    auto actions = pImpl->actions;
+    for (std::size_t i = 0; i < strategies.size(); ++i) {
+        pImpl->actions = actions;
+        if (!run(strategies[i])) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/// Returns name of the class of solver rules used in Goal::Stats
+static const char *
+ruleClassName(SolverRuleinfo ruleClass)
+{
+    switch (ruleClass) {
+        case SOLVER_RULE_PKG:
+            return "pkg";
+        case SOLVER_RULE_UPDATE:
+            return "update";
+        case SOLVER_RULE_FEATURE:
+            return "feature";
+        case SOLVER_RULE_JOB:
+            return "job";
+        case SOLVER_RULE_DISTUPGRADE:
+            return "distupgrade";
+        case SOLVER_RULE_INFARCH:
+            return "infarch";
+        case SOLVER_RULE_CHOICE:
+            return "choice";
+        case SOLVER_RULE_LEARNT:
+            return "learnt";
+        case SOLVER_RULE_BEST:
+            return "best";
+        case SOLVER_RULE_YUMOBS:
+            return "yumobs";
+        case SOLVER_RULE_RECOMMENDS:
+            return "recommends";
+        case SOLVER_RULE_BLACK:
+            return "black";
+        default:
+            return "other";
+    }
+}
+
+Goal::Stats
+Goal::getStats()
+{
+    Stats stats;
+    stats.solvePasses = pImpl->solvePasses;
+    stats.phaseTimes = pImpl->phaseTimes;
+    Solver *solv = pImpl->solv;
+    if (!solv)
+        return stats;
+
+    // The number of rules is private to libsolv. Rule classes occupy consecutive ranges of rule
+    // ids ending with the learnt rules, solver_ruleclass() returns SOLVER_RULE_UNKNOWN for all ids
+    // past them. Classes without a name (e.g. added by a newer libsolv) are counted as "other".
+    SolverRuleinfo ruleClass;
+    for (Id rid = 1; (ruleClass = solver_ruleclass(solv, rid)) != SOLVER_RULE_UNKNOWN; ++rid)
+        ++stats.rules[ruleClassName(ruleClass)];
+    auto learnt = stats.rules.find("learnt");
+    if (learnt != stats.rules.end())
+        stats.learntRules = learnt->second;
+
+    IdQueue decisions;
+    solver_get_decisionqueue(solv, decisions.getQueue());
+    stats.decisions = decisions.size();
+    return stats;
+}
+
 int
 Goal::countProblems()
 {
@@ -1232,6 +1381,64 @@ Goal::writeDebugdata(const char *dir)
     }
 }
 
+/**
+ * Sorts the transaction steps by their type. All list*() methods are served from the result, so
+ * transaction_type() is computed only once per step.
+ */
+void
+Goal::Impl::classifyTransaction()
+{
+    const int common_mode = SOLVER_TRANSACTION_SHOW_OBSOLETES |
+        SOLVER_TRANSACTION_CHANGE_IS_REINSTALL;
+
+    stepsByType.reset(new std::map<Id, PackageSet>);
+    obsoletedSteps.reset(new PackageSet(sack));
+    for (int i = 0; i < trans->steps.count; ++i) {
+        Id p = trans->steps.elements[i];
+        Id type = transaction_type(trans, p, common_mode |
+                                   SOLVER_TRANSACTION_SHOW_ACTIVE|
+                                   SOLVER_TRANSACTION_SHOW_ALL);
+        auto steps = stepsByType->find(type);
+        if (steps == stepsByType->end())
+            steps = stepsByType->emplace(type, PackageSet(sack)).first;
+        steps->second.set(p);
+
+        if (transaction_type(trans, p, common_mode) == SOLVER_TRANSACTION_OBSOLETED)
+            obsoletedSteps->set(p);
+    }
+}
+
+/**
+ * Frees the transaction together with everything computed from it
+ */
+void
+Goal::Impl::resetTransaction()
+{
+    if (trans) {
+        if (!solved)
+            transaction_free(trans);
+        trans = NULL;
+    }
+    stepsByType.reset();
+    obsoletedSteps.reset();
+    obsoletedByPackage.clear();
+}
+
+/**
+ * Frees the solver and the transaction unless they are shared through the solve cache
+ */
+void
+Goal::Impl::releaseSolver()
+{
+    resetTransaction();
+    if (solved) {
+        solved.reset();
+    } else if (solv) {
+        solver_free(solv);
+    }
+    solv = nullptr;
+}
+
 PackageSet
 Goal::Impl::listResults(Id type_filter1, Id type_filter2)
 {
@@ -1246,27 +1453,20 @@ Goal::Impl::listResults(Id type_filter1, Id type_filter2)
         throw Goal::Error(_("no solution possible"), DNF_ERROR_NO_SOLUTION);
     }
 
-    PackageSet plist(sack);
-    const int common_mode = SOLVER_TRANSACTION_SHOW_OBSOLETES |
-        SOLVER_TRANSACTION_CHANGE_IS_REINSTALL;
+    if (!stepsByType)
+        classifyTransaction();
 
-    for (int i = 0; i < trans->steps.count; ++i) {
-        Id p = trans->steps.elements[i];
-        Id type;
+    // obsoleted steps are classified without showing active steps
+    if (type_filter1 == SOLVER_TRANSACTION_OBSOLETED)
+        return *obsoletedSteps;
 
-        switch (type_filter1) {
-        case SOLVER_TRANSACTION_OBSOLETED:
-            type =  transaction_type(trans, p, common_mode);
-            break;
-        default:
-            type  = transaction_type(trans, p, common_mode |
-                                     SOLVER_TRANSACTION_SHOW_ACTIVE|
-                                     SOLVER_TRANSACTION_SHOW_ALL);
-            break;
-        }
-
-        if (type == type_filter1 || (type_filter2 && type == type_filter2))
-            plist.set(p);
+    PackageSet plist(sack);
+    for (Id type : {type_filter1, type_filter2}) {
+        if (!type)
+            continue;
+        auto steps = stepsByType->find(type);
+        if (steps != stepsByType->end())
+            plist += steps->second;
     }
     return plist;
 }
@@ -1335,13 +1535,20 @@ PackageSet
 Goal::listObsoletedByPackage(DnfPackage *pkg)
 {
     auto trans = pImpl->trans;
-    IdQueue obsoletes;
     PackageSet pset(pImpl->sack);
 
     assert(trans);
 
-    transaction_all_obs_pkgs(trans, dnf_package_get_id(pkg), obsoletes.getQueue());
-    queue2pset(obsoletes, &pset);
+    Id id = dnf_package_get_id(pkg);
+    auto cached = pImpl->obsoletedByPackage.find(id);
+    if (cached == pImpl->obsoletedByPackage.end()) {
+        IdQueue obsoletes;
+        transaction_all_obs_pkgs(trans, id, obsoletes.getQueue());
+        cached = pImpl->obsoletedByPackage.emplace(
+            id, std::vector<Id>(obsoletes.data(), obsoletes.data() + obsoletes.size())).first;
+    }
+    for (Id obsoleted : cached->second)
+        pset.set(obsoleted);
 
     return pset;
 }
@@ -1442,15 +1649,34 @@ Goal::Impl::constructJob(DnfGoalActions flags)
     return job;
 }
 
+/**
+ * Returns the solver of the goal prepared for the next run. The solver is kept between runs, so
+ * fallback runs with different flags reuse it. solver_solve() rebuilds the job and policy rules,
+ * but keeps the package rules (up to pkgrules_end) built from the dependencies of the considered
+ * packages. A new solver is therefore created when
+ * - packages were added to the pool, the solver is sized for them at creation,
+ * - the installed repo changed,
+ * - the sack generation changed (dnf_sack_get_generation()), e.g. after excludes changed the
+ *   considered packages, because the kept package rules would describe the old ones.
+ */
 Solver *
 Goal::Impl::initSolver()
 {
     Pool *pool = dnf_sack_get_pool(sack);
-    Solver *solvNew = solver_create(pool);
 
-    if (solv)
-        solver_free(solv);
-    solv = solvNew;
+    // a solver shared through the solve cache must stay as it is
+    if (solved)
+        releaseSolver();
+    auto generation = dnf_sack_get_generation(sack);
+    if (!solv || solverNsolvables != pool->nsolvables || solverInstalled != pool->installed ||
+        solverGeneration != generation) {
+        if (solv)
+            solver_free(solv);
+        solv = solver_create(pool);
+        solverNsolvables = pool->nsolvables;
+        solverInstalled = pool->installed;
+        solverGeneration = generation;
+    }
 
     /* vendor locking */
     int vendor = dnf_sack_get_allow_vendor_change(sack) ? 1 : 0;
@@ -1482,41 +1708,52 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
     Pool *pool = dnf_sack_get_pool(sack);
     int reresolve = 0;
 
+    // The limit can only be exceeded by installing a new installonly package. In the common case
+    // there is none among the decisions and the providers of installonly provides are not scanned.
+    auto installonlyMap = dnf_sack_get_installonly_map(sack);
+    IdQueue decisions;
+    solver_get_decisionqueue(solv, decisions.getQueue());
+    bool installingInstallonly = false;
+    for (int i = 0; i < decisions.size(); ++i) {
+        Id p = decisions[i];
+        // According to libsolv-bindings the decision is positive for installs
+        if (p > 0 && MAPTST(installonlyMap, p) && pool_id2solvable(pool, p)->repo != pool->installed) {
+            installingInstallonly = true;
+            break;
+        }
+    }
+    if (!installingInstallonly)
+        return 0;
+
     for (int i = 0; i < onlies->count; ++i) {
         Id p, pp;
-        IdQueue q, installing;
-        std::vector<Solvable *> available_unused_providers;
+        IdQueue q;
+        bool installing = false;
 
-        // Add all providers of installonly provides that are marked for install
-        // to `q` IdQueue those that are not marked for install and are not already
-        // installed are added to available_unused_providers.
+        // Add all providers of installonly provides that are marked for install to `q` IdQueue
         FOR_PKG_PROVIDES(p, pp, onlies->elements[i])
             // According to libsolv-bindings the decision level is positive for installs
             // and negative for conflicts (conflicts with another package or dependency
             // conflicts = dependencies cannot be met).
             if (solver_get_decisionlevel(solv, p) > 0) {
                 q.pushBack(p);
-            } else {
-                Solvable *s = pool_id2solvable(pool, p);
-                if (s->repo != pool->installed) {
-                    available_unused_providers.push_back(s);
-                }
+                if (pool_id2solvable(pool, p)->repo != pool->installed)
+                    installing = true;
             }
 
-        if (q.size() <= (int) dnf_sack_get_installonly_limit(sack)) {
+        if (!installing || q.size() <= (int) dnf_sack_get_installonly_limit(sack)) {
             continue;
         }
-        for (int k = 0; k < q.size(); ++k) {
-            Id id  = q[k];
-            Solvable *s = pool_id2solvable(pool, id);
-            if (pool->installed != s->repo) {
-                installing.pushBack(id);
-                break;
+
+        // Providers that are not marked for install and are not already installed
+        std::vector<Solvable *> available_unused_providers;
+        FOR_PKG_PROVIDES(p, pp, onlies->elements[i])
+            if (solver_get_decisionlevel(solv, p) <= 0) {
+                Solvable *s = pool_id2solvable(pool, p);
+                if (s->repo != pool->installed) {
+                    available_unused_providers.push_back(s);
+                }
             }
-        }
-        if (!installing.size()) {
-            continue;
-        }
 
         struct InstallonliesSortCallback s_cb = {pool, dnf_sack_running_kernel(sack)};
         solv_sort(q.data(), q.size(), sizeof(q[0]), sort_packages, &s_cb);
@@ -1549,6 +1786,40 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
     return reresolve;
 }
 
+/**
+ * Returns key of the goal in the solve cache of the sack. It covers everything that solve()
+ * depends on besides the sack generation.
+ */
+std::string
+Goal::Impl::getSolveSignature(const Queue *job, DnfGoalActions flags)
+{
+    std::string signature;
+    const int settings[] = {
+        flags,
+        actions,
+        dnf_sack_get_allow_vendor_change(sack),
+        static_cast<int>(dnf_sack_get_installonly_limit(sack)),
+        protectedRunningKernel(),
+    };
+    signature.append(reinterpret_cast<const char *>(settings), sizeof(settings));
+    signature.append(reinterpret_cast<const char *>(&job->count), sizeof(job->count));
+    signature.append(reinterpret_cast<const char *>(job->elements), job->count * sizeof(Id));
+    // installonly names are not covered by the generation of the sack
+    Queue *installonly = dnf_sack_get_installonly(sack);
+    signature.append(reinterpret_cast<const char *>(&installonly->count), sizeof(installonly->count));
+    signature.append(reinterpret_cast<const char *>(installonly->elements),
+                     installonly->count * sizeof(Id));
+    if (protectedPkgs) {
+        // equal sets may differ in the size of the map, trailing zeros are skipped
+        auto map = protectedPkgs->getMap();
+        int size = map->size;
+        while (size > 0 && map->map[size - 1] == 0)
+            --size;
+        signature.append(reinterpret_cast<const char *>(map->map), size);
+    }
+    return signature;
+}
+
 bool
 Goal::Impl::solve(Queue *job, DnfGoalActions flags)
 {
@@ -1556,12 +1827,7 @@ Goal::Impl::solve(Queue *job, DnfGoalActions flags)
     dnf_sack_recompute_considered(sack);
 
     dnf_sack_make_provides_ready(sack);
-    if (trans) {
-        transaction_free(trans);
-        trans = NULL;
-    }
-
-    Solver *solv = initSolver();
+    resetTransaction();
 
     /* Removal of SOLVER_WEAK to allow report errors*/
     if (DNF_IGNORE_WEAK & flags) {
@@ -1570,25 +1836,69 @@ Goal::Impl::solve(Queue *job, DnfGoalActions flags)
         }
     }
 
-    if (DNF_IGNORE_WEAK_DEPS & flags)
-        solver_set_flag(solv, SOLVER_FLAG_IGNORE_RECOMMENDED, 1);
+    auto cache = dnf_sack_get_solve_cache(sack);
+    std::string signature;
+    if (cache) {
+        signature = getSolveSignature(job, flags);
+        if (auto cached = cache->find(signature, dnf_sack_get_generation(sack))) {
+            releaseSolver();
+            solved = *cached;
+            solv = solved->solv;
+            trans = solved->trans;
+            PhaseTimer timer(phaseTimes, "protected");
+            return !trans || protectedInRemovals();
+        }
+    }
 
-    if (DNF_ALLOW_DOWNGRADE & actions)
-        solver_set_flag(solv, SOLVER_FLAG_ALLOW_DOWNGRADE, 1);
+    Solver *solv;
+    {
+        PhaseTimer timer(phaseTimes, "solver");
+        solv = initSolver();
+    }
 
-    if (solver_solve(solv, job))
-        return true;
+    /* flags of a previous run of the solver must not leak into this one */
+    solver_set_flag(solv, SOLVER_FLAG_IGNORE_RECOMMENDED, (DNF_IGNORE_WEAK_DEPS & flags) ? 1 : 0);
+    solver_set_flag(solv, SOLVER_FLAG_ALLOW_DOWNGRADE, (DNF_ALLOW_DOWNGRADE & actions) ? 1 : 0);
+
+    bool problems;
+    {
+        PhaseTimer timer(phaseTimes, "solve");
+        ++solvePasses;
+        problems = solver_solve(solv, job) != 0;
+    }
     // either allow solutions callback or installonlies, both at the same time
     // are not supported
-    if (limitInstallonlyPackages(solv, job)) {
-        // allow erasing non-installonly packages that depend on a kernel about
-        // to be erased
-        allowUninstallAllButProtected(job, DNF_ALLOW_UNINSTALL);
-        if (solver_solve(solv, job))
-            return true;
+    if (!problems) {
+        bool limited;
+        {
+            PhaseTimer timer(phaseTimes, "installonly");
+            limited = limitInstallonlyPackages(solv, job);
+            if (limited) {
+                // allow erasing non-installonly packages that depend on a kernel about
+                // to be erased
+                allowUninstallAllButProtected(job, DNF_ALLOW_UNINSTALL);
+            }
+        }
+        if (limited) {
+            PhaseTimer timer(phaseTimes, "solve");
+            ++solvePasses;
+            problems = solver_solve(solv, job) != 0;
+        }
     }
-    trans = solver_create_transaction(solv);
+    if (!problems) {
+        PhaseTimer timer(phaseTimes, "transaction");
+        trans = solver_create_transaction(solv);
+    }
+
+    if (cache) {
+        solved = std::make_shared<SolvedGoal>(solv, trans);
+        cache->insert(std::move(signature), dnf_sack_get_generation(sack), solved);
+    }
+
+    if (problems)
+        return true;
 
+    PhaseTimer timer(phaseTimes, "protected");
     if (protectedInRemovals())
         return true;
 
@@ -1706,13 +2016,11 @@ Goal::Impl::protectedInRemovals()
         return false;
     auto pkgRemoveList = listResults(SOLVER_TRANSACTION_ERASE, 0);
     Id protected_kernel = protectedRunningKernel();
-    auto pkgObsoleteList = listResults(SOLVER_TRANSACTION_OBSOLETED, 0);
     // Special case: consider the obsoletion of the running kernel as a
     // removal. Obsoletion of other protected packages should be allowed.
-    for (size_t obsolete_index = 0; obsolete_index < pkgObsoleteList.size(); obsolete_index += 1) {
-        if (protected_kernel == pkgObsoleteList[obsolete_index]) {
-            pkgRemoveList.set(protected_kernel);
-        }
+    if (protected_kernel > 0 &&
+        listResults(SOLVER_TRANSACTION_OBSOLETED, 0).has(protected_kernel)) {
+        pkgRemoveList.set(protected_kernel);
     }
 
     // We want to allow obsoletion of protected packages, so we do not consider
@@ -1721,18 +2029,13 @@ Goal::Impl::protectedInRemovals()
     // obsoleting/swapping a protected package, such as to obsolete `dnf` in
     // favor of `dnf5`. Obsoleting a package is much harder to do accidentally
     // than removing it.
-    removalOfProtected.reset(new PackageSet(pkgRemoveList));
+    removalOfProtected.reset(new PackageSet(sack));
     Id id = -1;
-    while(true) {
-        id = removalOfProtected->next(id);
-        if (id == -1)
-            break;
-
-        if (protectedPkgs->has(id) || id == protected_kernel) {
+    while ((id = pkgRemoveList.next(id)) != -1) {
+        if ((protectedPkgs && protectedPkgs->has(id)) || id == protected_kernel) {
+            removalOfProtected->set(id);
             ret = true;
             i++;
-        } else {
-            removalOfProtected->remove(id);
         }
     }
     return ret;
@@ -1766,7 +2069,7 @@ Goal::Impl::describeProtectedRemoval()
     Id protected_kernel = protectedRunningKernel();
     std::vector<const char *> names;
     while((id = pset->next(id)) != -1) {
-        if (protectedPkgs->has(id) || id == protected_kernel) {
+        if ((protectedPkgs && protectedPkgs->has(id)) || id == protected_kernel) {
             Solvable * s = pool_id2solvable(pool, id);
             names.push_back(pool_id2str(pool, s->name));
         }
@@ -21,8 +21,10 @@
 #ifndef __GOAL_HPP
 #define __GOAL_HPP
 
+#include <map>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "../dnf-types.h"
@@ -42,6 +44,23 @@ public:
         int errCode;
     };
 
+    /**
+    * @brief Statistics of the last run of the goal
+    */
+    struct Stats {
+        /// Number of solver rules by class ("pkg", "job", "update", "learnt", ..., "other")
+        std::map<std::string, int> rules;
+        /// Number of decisions taken by the solver
+        int decisions{0};
+        /// Number of rules learnt by the solver while resolving conflicts
+        int learntRules{0};
+        /// Number of solver_solve() calls, 0 when the solution was taken from the solve cache
+        int solvePasses{0};
+        /// Wall time in seconds by phase ("job", "solver", "solve", "installonly", "transaction",
+        /// "protected")
+        std::map<std::string, double> phaseTimes;
+    };
+
     Goal(DnfSack *sack);
     Goal(const Goal & goal_src);
     Goal(Goal && goal_src) = delete;
@@ -116,6 +135,22 @@ public:
     /* resolving the goal */
     bool run(DnfGoalActions flags);
 
+    /**
+    * @brief Resolves the goal with the strategies in preference order and keeps the first
+    * solution found. When every strategy fails, the goal keeps problems of the last one.
+    *
+    * @param strategies Flags passed to run() in preference order
+    * @return int Index of the strategy that was solved, -1 when none was
+    */
+    int runWithFallbacks(const std::vector<DnfGoalActions> & strategies);
+
+    /**
+    * @brief Returns statistics of the last run of the goal
+    *
+    * @return Stats
+    */
+    Stats getStats();
+
     /* problems */
     int countProblems();
 
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __SOLVED_GOAL_HPP
+#define __SOLVED_GOAL_HPP
+
+#include "../utils/LruCache.hpp"
+
+#include <memory>
+
+// libsolv
+#include <solv/solver.h>
+#include <solv/transaction.h>
+
+namespace libdnf {
+
+/**
+* @brief Solver and transaction of a resolved goal. It is shared by goals resolved from an identical
+* job through the solve cache of the sack.
+*/
+struct SolvedGoal {
+    SolvedGoal(Solver * solv, ::Transaction * trans) : solv(solv), trans(trans) {}
+    SolvedGoal(const SolvedGoal &) = delete;
+    SolvedGoal & operator=(const SolvedGoal &) = delete;
+    ~SolvedGoal()
+    {
+        if (trans)
+            transaction_free(trans);
+        solver_free(solv);
+    }
+
+    Solver * const solv;
+    /// nullptr when the goal has no solution
+    ::Transaction * const trans;
+};
+
+/// Resolved goals of a sack keyed by signatures of their jobs
+typedef LruCache<std::shared_ptr<SolvedGoal>> SolveCache;
+
+}
+
+#endif // __SOLVED_GOAL_HPP
@@ -32,5 +32,11 @@
 Pool        *dnf_package_get_pool       (DnfPackage *pkg);
 DnfSack     *dnf_package_get_sack       (DnfPackage *pkg);
 std::vector<libdnf::Changelog>   dnf_package_get_changelogs (DnfPackage *pkg);
+DnfPackage  *dnf_package_new_shared     (DnfSack *sack, Id id);
+
+/**
+ * @brief Detaches the package from the shared packages of its sack, used when the sack goes away
+ */
+void         dnf_package_unshare        (DnfPackage *pkg);
 
 #endif // __HY_PACKAGE_INTERNAL_H
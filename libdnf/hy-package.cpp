@@ -55,6 +55,7 @@ typedef struct
     gboolean         loaded;
     Id               id;
     DnfSack         *sack;
+    gboolean         shared;    /* registered in the shared packages of the sack */
 } DnfPackagePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(DnfPackage, dnf_package, G_TYPE_OBJECT)
@@ -66,6 +67,9 @@ G_DEFINE_TYPE_WITH_PRIVATE(DnfPackage, dnf_package, G_TYPE_OBJECT)
 static void
 dnf_package_finalize(GObject *object)
 {
+    DnfPackagePrivate *priv = GET_PRIVATE(DNF_PACKAGE(object));
+    if (priv->shared)
+        dnf_sack_get_shared_packages(priv->sack)[priv->id] = nullptr;
     G_OBJECT_CLASS(dnf_package_parent_class)->finalize(object);
 }
 
@@ -107,6 +111,43 @@ dnf_package_new(DnfSack *sack, Id id)
     return pkg;
 }
 
+/**
+ * dnf_package_new_shared: (skip)
+ * @sack: a #DnfSack instance.
+ * @id: the package ID
+ *
+ * Returns the instance of the package shared by all callers that hold a reference to it, creating
+ * it when there is none. The sack does not keep shared packages alive. Shared packages must not
+ * be modified, e.g. with dnf_package_set_info(), use dnf_package_new() for that. An @id that is
+ * not a solvable of the pool gets a new unshared instance, like from dnf_package_new().
+ *
+ * Returns:(transfer full): a #DnfPackage
+ */
+DnfPackage *
+dnf_package_new_shared(DnfSack *sack, Id id)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    if (id <= 0 || id >= pool->nsolvables)
+        return dnf_package_new(sack, id);
+
+    auto & shared = dnf_sack_get_shared_packages(sack);
+    if (id < static_cast<Id>(shared.size()) && shared[id])
+        return DNF_PACKAGE(g_object_ref(shared[id]));
+
+    if (id >= static_cast<Id>(shared.size()))
+        shared.resize(pool->nsolvables, nullptr);
+    auto pkg = dnf_package_new(sack, id);
+    GET_PRIVATE(pkg)->shared = TRUE;
+    shared[id] = pkg;
+    return pkg;
+}
+
+void
+dnf_package_unshare(DnfPackage *pkg)
+{
+    GET_PRIVATE(pkg)->shared = FALSE;
+}
+
 
 /* internal */
 static Solvable *
@@ -35,6 +35,7 @@ extern "C" {
 #include "libdnf/repo/Repo-private.hpp"
 #include "libdnf/sack/query.hpp"
 #include "libdnf/log.hpp"
+#include "libdnf/nevra.hpp"
 #include "../utils/bgettext/bgettext-lib.h"
 #include "tinyformat/tinyformat.hpp"
 
@@ -124,6 +125,9 @@ ModulePackage::ModulePackage(const ModulePackage & mpkg)
         , moduleSack(mpkg.moduleSack)
         , repoID(mpkg.repoID)
         , id(mpkg.id)
+        , artifactIdsSack(mpkg.artifactIdsSack)
+        , artifactIdsNSolvables(mpkg.artifactIdsNSolvables)
+        , artifactIds(mpkg.artifactIds)
 {
     if (mdStream != nullptr) {
         g_object_ref(mdStream);
@@ -143,6 +147,9 @@ ModulePackage & ModulePackage::operator=(const ModulePackage & mpkg)
         moduleSack = mpkg.moduleSack;
         repoID = mpkg.repoID;
         id = mpkg.id;
+        artifactIdsSack = mpkg.artifactIdsSack;
+        artifactIdsNSolvables = mpkg.artifactIdsNSolvables;
+        artifactIds = mpkg.artifactIds;
     }
     return *this;
 }
@@ -418,6 +425,36 @@ std::vector<std::string> ModulePackage::getArtifacts() const
     return result_rpms;
 }
 
+const std::vector<ModulePackage::ArtifactId> & ModulePackage::getArtifactIds(DnfSack * sack) const
+{
+    Pool * pool = dnf_sack_get_pool(sack);
+    auto serial = dnf_sack_get_serial(sack);
+    if (artifactIdsSack == serial && artifactIdsNSolvables == pool->nsolvables) {
+        return artifactIds;
+    }
+    artifactIds.clear();
+    Nevra nevra;
+    char ** rpms = modulemd_module_stream_v2_get_rpm_artifacts_as_strv((ModulemdModuleStreamV2 *) mdStream);
+    for (char **iter = rpms; iter && *iter; iter++) {
+        if (!nevra.parse(*iter, HY_FORM_NEVRA)) {
+            continue;
+        }
+        // libsolv strips the zero epoch from evr of solvables
+        auto evr = nevra.getEpoch() > 0 ? nevra.getEvr() : nevra.getVersion() + "-" + nevra.getRelease();
+        // strings are only looked up, a string unknown to the pool is not used by any package
+        Id name = pool_str2id(pool, nevra.getName().c_str(), 0);
+        if (!name) {
+            continue;
+        }
+        artifactIds.push_back({name, pool_str2id(pool, evr.c_str(), 0),
+                               pool_str2id(pool, nevra.getArch().c_str(), 0)});
+    }
+    g_strfreev(rpms);
+    artifactIdsSack = serial;
+    artifactIdsNSolvables = pool->nsolvables;
+    return artifactIds;
+}
+
 /**
  * @brief Return sorted list of RPM names that are demodularized.
  *
@@ -543,6 +580,23 @@ void ModulePackage::addStreamConflict(const ModulePackage * package)
     solvable_add_deparray(solvable, SOLVABLE_CONFLICTS, depId, 0);
 }
 
+std::vector<std::string> ModulePackage::getConflicts() const
+{
+    Pool * pool = dnf_sack_get_pool(moduleSack);
+    Solvable * solvable = pool_id2solvable(pool, id);
+    Queue conflicts;
+    queue_init(&conflicts);
+    solvable_lookup_deparray(solvable, SOLVABLE_CONFLICTS, &conflicts, 0);
+
+    std::vector<std::string> result;
+    result.reserve(conflicts.count);
+    for (int i = 0; i < conflicts.count; ++i) {
+        result.emplace_back(pool_dep2str(pool, conflicts.elements[i]));
+    }
+    queue_free(&conflicts);
+    return result;
+}
+
 static std::pair<std::string, std::string> getPlatformStream(const std::string &osReleasePath)
 {
     auto file = File::newFile(osReleasePath);
@@ -60,6 +60,22 @@ public:
 
     std::vector<std::string> getArtifacts() const;
 
+    /// NEVRA of an artifact as Ids of a pool, evr or arch is 0 when the string is unknown to the pool
+    struct ArtifactId {
+        Id name;
+        Id evr;
+        Id arch;
+    };
+
+    /**
+    * @brief Return artifacts parsed into name, evr and arch Ids of the pool of the sack. Artifacts are
+    * parsed at the first call, the result is kept until the sack gets new packages. Invalid NEVRAs and
+    * artifacts with a name unknown to the pool are skipped, no package of the sack can match them.
+    *
+    * @return const std::vector<ArtifactId> &
+    */
+    const std::vector<ArtifactId> & getArtifactIds(DnfSack * sack) const;
+
     /// Return sorted list of RPM names that are demodularized.
     std::vector<std::string> getDemodularizedRpms() const;
 
@@ -78,6 +94,13 @@ public:
     ///DEPRECATED
     void addStreamConflict(const ModulePackage * package);
 
+    /**
+     * @brief Returns strings of conflicts of the module solvable ("module(nodejs)", "module(nodejs:12)")
+     *
+     * @return std::vector< std::string >
+     */
+    std::vector<std::string> getConflicts() const;
+
     Id getId() const { return id; };
     std::string getYaml() const;
 
@@ -121,6 +144,10 @@ private:
     DnfSack * moduleSack;
     std::string repoID;
     Id id;
+    /// Cache of getArtifactIds() with the serial and the number of solvables of the sack
+    mutable guint64 artifactIdsSack{0};
+    mutable int artifactIdsNSolvables{0};
+    mutable std::vector<ArtifactId> artifactIds;
 };
 
 inline bool ModulePackage::operator==(const ModulePackage &r) const
@@ -19,10 +19,16 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
 #include <set>
+#include <unordered_map>
 #include <sstream>
+#include <tuple>
 
 extern "C" {
+#include <solv/evr.h>
 #include <solv/poolarch.h>
 #include <solv/solver.h>
 }
@@ -32,6 +38,7 @@ extern "C" {
 #include "libdnf/utils/utils.hpp"
 #include "libdnf/utils/File.hpp"
 #include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/hy-iutil-private.hpp"
 #include "libdnf/hy-query.h"
 #include "libdnf/hy-types.h"
 #include <functional>
@@ -138,6 +145,17 @@ toString(const ModulePackageContainer::ModuleState &state) {
     }
 }
 
+namespace {
+
+struct ModuleIndexDeleter {
+    void operator()(ModulemdModuleIndex * index) noexcept { g_object_unref(index); }
+};
+
+/// Owned parsed metadata, released also when a concurrent parsing is abandoned
+using ModuleIndexPtr = std::unique_ptr<ModulemdModuleIndex, ModuleIndexDeleter>;
+
+}
+
 static std::string getFileContent(const std::string &filePath)
 {
     auto yaml = File::newFile(filePath);
@@ -191,6 +209,16 @@ public:
     std::vector<ModulePackage *> getLatestActiveEnabledModules();
     /// Required to call after all modules v3 are in metadata
     void addVersion2Modules();
+    /// Adds modules of parsed metadata of a repository
+    void addModules(ModulemdModuleIndex * index, const std::string & repoID);
+    /// Rebuilds artifactOwners for activatedModules with Ids of the pool of the sack
+    void indexArtifactOwners(DnfSack * sack);
+    /// Sorts modules for selection of the latest ones when modules were added since the last call
+    void updateLatestOrder();
+    /// Returns packages of the pool matched by artifacts of the module, computed at the first use
+    const std::vector<Id> & getArtifactPackages(DnfSack * sack, ModulePackage * module);
+    /// Returns packages of the pool filtered out by an artifact name of an active module
+    const std::vector<Id> & getPackagesByArtifactName(Pool * pool, Id nameId, bool source);
 
 private:
     friend struct ModulePackageContainer;
@@ -207,6 +235,37 @@ private:
     /// solvable.conflicts = module(<moduleName>)
     DnfSack * moduleSack;
     std::unique_ptr<PackageSet> activatedModules;
+    /// Artifacts of activated modules as <name, evr, arch> Ids of the package pool with the Id
+    /// of the owning module, sorted by the artifact
+    struct ArtifactOwner {
+        Id name;
+        Id evr;
+        Id arch;
+        Id module;
+    };
+    std::vector<ArtifactOwner> artifactOwners;
+    /// Serial and number of solvables of the sack of the artifactOwners Ids, the serial is 0
+    /// when activatedModules changed since indexing
+    guint64 artifactOwnersSack{0};
+    int artifactOwnersNSolvables{0};
+    /// Modules sorted by repository, name, stream, arch and descending version
+    std::vector<ModulePackage *> latestPerRepoOrder;
+    /// Module Ids sorted by solvable name, arch and descending version
+    std::vector<Id> latestPerArchOrder;
+    /// Number of modules when the orders were sorted
+    std::size_t latestOrderModules{0};
+    /// Packages of the pool matched by artifacts, valid while the sack (by its serial) and its solvables
+    /// are the same. They do not depend on the state of modules.
+    guint64 artifactPackagesSack{0};
+    int artifactPackagesNSolvables{0};
+    /// Packages with NEVRA of an artifact of the module
+    std::map<Id, std::vector<Id>> artifactPackages;
+    /// Packages filtered out by an artifact name, the flag is set for source artifacts. Providers of
+    /// the name are included, whatprovides of the sack ignores excludes, so they only change with
+    /// new solvables.
+    std::map<std::pair<Id, bool>, std::vector<Id>> packagesByArtifactName;
+    /// Packages of the pool grouped by name Id
+    std::unordered_map<Id, std::vector<Id>> packagesByName;
     std::string installRoot;
     std::string persistDir;
     ModuleMetadata moduleMetadata;
@@ -245,6 +304,8 @@ public:
     bool changeState(const std::string &name, ModuleState state);
 
     bool insert(const std::string &moduleName, const char *path);
+    /// Inserts modules of all "*.module" files in the directory in a single scan
+    void insertDirectory(const char *path);
     void rollback();
     void save(const std::string &installRoot, const std::string &modulesPath);
 
@@ -263,6 +324,8 @@ private:
     void reset(const std::string &name);
 
     std::map<std::string, std::pair<ConfigParser, struct Config>> configs;
+    /// Directory read by insertDirectory(), modules inserted later have no config file in it
+    std::string scannedDir;
 };
 
 ModulePackageContainer::EnableMultipleStreamsException::EnableMultipleStreamsException(
@@ -289,21 +352,7 @@ ModulePackageContainer::ModulePackageContainer(bool allArch, std::string install
     pImpl->installRoot = installRoot;
     g_autofree gchar * path = g_build_filename(pImpl->installRoot.c_str(),
                                               "/etc/dnf/modules.d", NULL);
-    std::unique_ptr<DIR> dir(opendir(path));
-    if (dir) {
-        struct dirent * ent;
-        /* Load "*.module" files into module persistor */
-        DIR * dirPtr = dir.get();
-        while ((ent = readdir(dirPtr)) != NULL) {
-            auto filename = ent->d_name;
-            auto fileNameLen = strlen(filename);
-            if (fileNameLen < 8 || strcmp(filename + fileNameLen - 7, ".module")) {
-                continue;
-            }
-            std::string name(filename, fileNameLen - 7);
-            pImpl->persistor->insert(name, path);
-        }
-    }
+    pImpl->persistor->insertDirectory(path);
 }
 
 ModulePackageContainer::~ModulePackageContainer() = default;
@@ -317,23 +366,67 @@ ModulePackageContainer::Impl::~Impl()
 
 void
 ModulePackageContainer::add(DnfSack * sack)
+{
+    add(sack, 0);
+}
+
+void
+ModulePackageContainer::add(DnfSack * sack, unsigned int maxThreads)
 {
     Pool * pool = dnf_sack_get_pool(sack);
     LibsolvRepo * r;
     Id id;
 
+    // The metadata of the repositories are read and parsed concurrently by at most maxThreads
+    // threads, one per processor by default. The module sack and the defaults are updated serially
+    // in the order of the repositories, so the first failure in that order is reported.
+    std::vector<std::pair<std::string, std::string>> modulesFiles;
     FOR_REPOS(id, r) {
         HyRepo hyRepo = static_cast<HyRepo>(r->appdata);
         auto modules_fn = hyRepo->getMetadataPath(MD_TYPE_MODULES);
         if (modules_fn.empty()) {
             continue;
         }
-        std::string yamlContent = getFileContent(modules_fn);
-        auto repoName = hyRepo->getId();
-        add(yamlContent, repoName);
+        modulesFiles.emplace_back(hyRepo->getId(), std::move(modules_fn));
+    }
+    if (modulesFiles.empty()) {
+        return;
+    }
+
+    std::vector<std::promise<ModuleIndexPtr>> parsed(modulesFiles.size());
+    std::vector<std::future<ModuleIndexPtr>> results;
+    for (auto & promise : parsed) {
+        results.push_back(promise.get_future());
+    }
+    std::atomic<std::size_t> next{0};
+    auto parse = [&modulesFiles, &parsed, &next]() {
+        for (std::size_t i; (i = next++) < modulesFiles.size();) {
+            try {
+                parsed[i].set_value(ModuleIndexPtr(ModuleMetadata::parseIndex(
+                    getFileContent(modulesFiles[i].second))));
+            } catch (...) {
+                parsed[i].set_exception(std::current_exception());
+            }
+        }
+    };
+    // destructors of the futures wait for the workers, also when an error is thrown below
+    std::vector<std::future<void>> workers;
+    if (maxThreads == 0) {
+        maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    auto nWorkers = std::min<std::size_t>(maxThreads, modulesFiles.size());
+    for (std::size_t i = 0; i < nWorkers; ++i) {
+        workers.push_back(std::async(std::launch::async, parse));
+    }
+
+    for (std::size_t i = 0; i < modulesFiles.size(); ++i) {
+        auto & repoName = modulesFiles[i].first;
+        // the metadata are parsed once for both the modules and the defaults
+        auto index = results[i].get();
+        pImpl->addModules(index.get(), repoName);
         // update defaults from repo
         try {
-            pImpl->moduleMetadata.addMetadataFromString(yamlContent, 0);
+            pImpl->moduleMetadata.addMetadataFromIndex(index.get(), 0);
         } catch (const ModulePackageContainer::ResolveException & exception) {
             throw ModulePackageContainer::ConflictException(
                 tfm::format(_("Conflicting defaults with repo '%s': %s"), repoName,
@@ -362,10 +455,17 @@ void ModulePackageContainer::moduleDefaultsResolve()
 void
 ModulePackageContainer::add(const std::string &fileContent, const std::string & repoID)
 {
-    Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+    g_autoptr(ModulemdModuleIndex) index = ModuleMetadata::parseIndex(fileContent);
+    pImpl->addModules(index, repoID);
+}
+
+void
+ModulePackageContainer::Impl::addModules(ModulemdModuleIndex * index, const std::string & repoID)
+{
+    Pool * pool = dnf_sack_get_pool(moduleSack);
 
     ModuleMetadata md;
-    md.addMetadataFromString(fileContent, 0);
+    md.addMetadataFromIndex(index, 0);
     md.resolveAddedMetadata();
 
     LibsolvRepo * repo = nullptr;
@@ -381,7 +481,7 @@ ModulePackageContainer::add(const std::string &fileContent, const std::string &
 
     // If not created yet, create it
     if (!repo) {
-        Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+        Pool * pool = dnf_sack_get_pool(moduleSack);
         HyRepo hrepo = hy_repo_create(repoID.c_str());
         auto repoImpl = libdnf::repoGetImpl(hrepo);
         repo = repo_create(pool, repoID.c_str());
@@ -391,12 +491,12 @@ ModulePackageContainer::add(const std::string &fileContent, const std::string &
     }
 
     // add all modules to repository and pass ownership to module container
-    g_autofree gchar * path = g_build_filename(pImpl->installRoot.c_str(), "/etc/dnf/modules.d", NULL);
-    auto packages = md.getAllModulePackages(pImpl->moduleSack, repo, repoID, pImpl->modulesV2);
+    g_autofree gchar * path = g_build_filename(installRoot.c_str(), "/etc/dnf/modules.d", NULL);
+    auto packages = md.getAllModulePackages(moduleSack, repo, repoID, modulesV2);
     for(auto const& modulePackagePtr: packages) {
         std::unique_ptr<ModulePackage> modulePackage(modulePackagePtr);
-        pImpl->modules.insert(std::make_pair(modulePackage->getId(), std::move(modulePackage)));
-        pImpl->persistor->insert(modulePackagePtr->getName(), path);
+        modules.insert(std::make_pair(modulePackage->getId(), std::move(modulePackage)));
+        persistor->insert(modulePackagePtr->getName(), path);
     }
 }
 
@@ -419,14 +519,33 @@ ModulePackageContainer::addPlatformPackage(DnfSack * sack,
 
 void ModulePackageContainer::createConflictsBetweenStreams()
 {
-    // TODO Use Query for filtering
+    Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+
+    // Modules grouped by interned module name. Each module is stored with the interned
+    // "module(<name>:<stream>)" dependency that other streams of the module conflict with.
+    std::unordered_map<Id, std::vector<std::pair<Id, Id>>> modulesByName;
     for (const auto &iter : pImpl->modules) {
         const auto &modulePackage = iter.second;
-
-        for (const auto &innerIter : pImpl->modules) {
-            if (modulePackage->getName() == innerIter.second->getName()
-                && modulePackage->getStream() != innerIter.second->getStream()) {
-                modulePackage->addStreamConflict(innerIter.second.get());
+        Id nameId = pool_str2id(pool, modulePackage->getNameCStr(), 1);
+        auto conflict = "module(" + modulePackage->getNameStream() + ")";
+        modulesByName[nameId].emplace_back(pool_str2id(pool, conflict.c_str(), 1), iter.first);
+    }
+
+    std::vector<Id> streams;
+    for (const auto &group : modulesByName) {
+        auto &modules = group.second;
+        streams.clear();
+        for (const auto &module : modules)
+            streams.push_back(module.first);
+        std::sort(streams.begin(), streams.end());
+        streams.erase(std::unique(streams.begin(), streams.end()), streams.end());
+        if (streams.size() < 2)
+            continue;
+        for (const auto &module : modules) {
+            Solvable * solvable = pool_id2solvable(pool, module.second);
+            for (Id stream : streams) {
+                if (stream != module.first)
+                    solvable_add_deparray(solvable, SOLVABLE_CONFLICTS, stream, 0);
             }
         }
     }
@@ -446,33 +565,187 @@ ModulePackage * ModulePackageContainer::getModulePackage(Id id)
 std::vector<ModulePackage *>
 ModulePackageContainer::requiresModuleEnablement(const PackageSet & packages)
 {
-    auto activatedModules = pImpl->activatedModules.get();
-    if (!activatedModules) {
+    if (!pImpl->activatedModules) {
         return {};
     }
+    auto sack = packages.getSack();
+    Pool * pool = dnf_sack_get_pool(sack);
+    if (pImpl->artifactOwnersSack != dnf_sack_get_serial(sack) ||
+        pImpl->artifactOwnersNSolvables != pool->nsolvables) {
+        pImpl->indexArtifactOwners(sack);
+    }
+
+    // the same packages a query of the install set would see
+    dnf_sack_recompute_considered(sack);
+    auto artifactLess = [](const Impl::ArtifactOwner & a, const Impl::ArtifactOwner & b) {
+        return std::tie(a.name, a.evr, a.arch) < std::tie(b.name, b.evr, b.arch);
+    };
+    std::set<Id> owners;
+    Id id = -1;
+    while ((id = packages.next(id)) != -1) {
+        if (pool->considered && !MAPTST(pool->considered, id)) {
+            continue;
+        }
+        Solvable * s = pool_id2solvable(pool, id);
+        auto range = std::equal_range(pImpl->artifactOwners.begin(), pImpl->artifactOwners.end(),
+                                      Impl::ArtifactOwner{s->name, s->evr, s->arch, 0}, artifactLess);
+        for (auto it = range.first; it != range.second; ++it) {
+            owners.insert(it->module);
+        }
+    }
+
     std::vector<ModulePackage *> output;
-    Query baseQuery(packages.getSack());
-    baseQuery.addFilter(HY_PKG, HY_EQ, &packages);
-    baseQuery.apply();
-    Query testQuery(baseQuery);
+    for (auto moduleId : owners) {
+        auto module = getModulePackage(moduleId);
+        if (!isEnabled(module)) {
+            output.push_back(module);
+        }
+    }
+    return output;
+}
+
+void
+ModulePackageContainer::Impl::indexArtifactOwners(DnfSack * sack)
+{
+    artifactOwners.clear();
     Id moduleId = -1;
     while ((moduleId = activatedModules->next(moduleId)) != -1) {
-        auto module = getModulePackage(moduleId);
-        if (isEnabled(module)) {
+        auto module = modules.find(moduleId);
+        if (module == modules.end()) {
             continue;
         }
-        auto includeNEVRAs = module->getArtifacts();
-        std::vector<const char *> includeNEVRAsCString(includeNEVRAs.size() + 1);
-        transform(includeNEVRAs.begin(), includeNEVRAs.end(), includeNEVRAsCString.begin(),
-                  std::mem_fn(&std::string::c_str));
-        testQuery.queryUnion(baseQuery);
-        testQuery.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, includeNEVRAsCString.data());
-        if (testQuery.empty()) {
+        for (const auto & artifact : module->second->getArtifactIds(sack)) {
+            artifactOwners.push_back({artifact.name, artifact.evr, artifact.arch, moduleId});
+        }
+    }
+    std::sort(artifactOwners.begin(), artifactOwners.end(),
+        [](const ArtifactOwner & a, const ArtifactOwner & b) {
+            return std::tie(a.name, a.evr, a.arch, a.module) < std::tie(b.name, b.evr, b.arch, b.module);
+        });
+    artifactOwnersSack = dnf_sack_get_serial(sack);
+    artifactOwnersNSolvables = dnf_sack_get_pool(sack)->nsolvables;
+}
+
+void
+ModulePackageContainer::getModularFilterPackages(DnfSack * sack, PackageSet & includes, PackageSet & excludes)
+{
+    Pool * pool = dnf_sack_get_pool(sack);
+    auto serial = dnf_sack_get_serial(sack);
+    if (pImpl->artifactPackagesSack != serial || pImpl->artifactPackagesNSolvables != pool->nsolvables) {
+        pImpl->artifactPackages.clear();
+        pImpl->packagesByArtifactName.clear();
+        pImpl->packagesByName.clear();
+        pImpl->artifactPackagesSack = serial;
+        pImpl->artifactPackagesNSolvables = pool->nsolvables;
+        Id id;
+        FOR_PKG_SOLVABLES(id) {
+            pImpl->packagesByName[pool_id2solvable(pool, id)->name].push_back(id);
+        }
+    }
+    dnf_sack_make_provides_ready(sack);
+
+    auto allPackages = getModulePackages();
+
+    // artifact names of the latest active modules which are not modular in name:stream.arch
+    std::map<std::string, std::set<Id>> demodularizedNames;
+    for (auto modulePackage : getLatestModules(allPackages, true)) {
+        auto demodularized = modulePackage->getDemodularizedRpms();
+        if (demodularized.empty()) {
             continue;
         }
-        output.push_back(module);
+        std::string packageID{modulePackage->getNameStream()};
+        packageID.append(".");
+        packageID.append(modulePackage->getArch());
+        auto & names = demodularizedNames[packageID];
+        for (const auto & name : demodularized) {
+            // a name unknown to the pool is not a name of any artifact
+            if (Id nameId = pool_str2id(pool, name.c_str(), 0)) {
+                names.insert(nameId);
+            }
+        }
     }
-    return output;
+
+    for (auto module : allPackages) {
+        // TODO use Goal::listInstalls() to not requires filtering out Platform
+        if (!isModuleActive(module->getId())) {
+            for (Id id : pImpl->getArtifactPackages(sack, module)) {
+                excludes.set(id);
+            }
+            continue;
+        }
+        for (Id id : pImpl->getArtifactPackages(sack, module)) {
+            includes.set(id);
+        }
+        std::string packageID{module->getNameStream()};
+        packageID.append(".");
+        packageID.append(module->getArch());
+        auto demodularized = demodularizedNames.find(packageID);
+        for (const auto & artifact : module->getArtifactIds(sack)) {
+            if (demodularized != demodularizedNames.end() && demodularized->second.count(artifact.name)) {
+                continue;
+            }
+            // source packages do not provide anything and must not cause excluding binary packages
+            bool source = artifact.arch == ARCH_SRC || artifact.arch == ARCH_NOSRC;
+            for (Id id : pImpl->getPackagesByArtifactName(pool, artifact.name, source)) {
+                excludes.set(id);
+            }
+        }
+    }
+}
+
+const std::vector<Id> &
+ModulePackageContainer::Impl::getArtifactPackages(DnfSack * sack, ModulePackage * module)
+{
+    auto it = artifactPackages.find(module->getId());
+    if (it != artifactPackages.end()) {
+        return it->second;
+    }
+
+    Pool * pool = dnf_sack_get_pool(sack);
+    auto & packages = artifactPackages[module->getId()];
+    for (const auto & artifact : module->getArtifactIds(sack)) {
+        auto sameName = packagesByName.find(artifact.name);
+        if (sameName == packagesByName.end()) {
+            continue;
+        }
+        for (Id id : sameName->second) {
+            Solvable * s = pool_id2solvable(pool, id);
+            if (s->evr == artifact.evr && s->arch == artifact.arch) {
+                packages.push_back(id);
+            }
+        }
+    }
+    return packages;
+}
+
+const std::vector<Id> &
+ModulePackageContainer::Impl::getPackagesByArtifactName(Pool * pool, Id nameId, bool source)
+{
+    auto key = std::make_pair(nameId, source);
+    auto it = packagesByArtifactName.find(key);
+    if (it != packagesByArtifactName.end()) {
+        return it->second;
+    }
+
+    auto & packages = packagesByArtifactName[key];
+    auto sameName = packagesByName.find(nameId);
+    if (sameName != packagesByName.end()) {
+        for (Id id : sameName->second) {
+            Id arch = pool_id2solvable(pool, id)->arch;
+            // source artifacts exclude only source packages, binary artifacts packages of any arch
+            if (!source || arch == ARCH_SRC || arch == ARCH_NOSRC) {
+                packages.push_back(id);
+            }
+        }
+    }
+    if (!source) {
+        // packages providing the name of a binary artifact
+        Id p, pp;
+        FOR_PROVIDES(p, pp, nameId) {
+            packages.push_back(p);
+        }
+    }
+    return packages;
 }
 
 
@@ -682,6 +955,8 @@ std::pair<std::vector<std::vector<std::string>>, ModulePackageContainer::ModuleE
 ModulePackageContainer::Impl::moduleSolve(const std::vector<ModulePackage *> & modules,
     bool debugSolver)
 {
+    // activatedModules are replaced below
+    artifactOwnersSack = 0;
     if (modules.empty()) {
         activatedModules.reset();
         return std::make_pair(std::vector<std::vector<std::string>>(),
@@ -1021,6 +1296,46 @@ modulePackageLatestPerRepoSorter(DnfSack * sack, const ModulePackage * first, co
     return first->getVersionNum() > second->getVersionNum();
 }
 
+void
+ModulePackageContainer::Impl::updateLatestOrder()
+{
+    if (latestOrderModules == modules.size()) {
+        return;
+    }
+    latestPerRepoOrder.clear();
+    latestPerArchOrder.clear();
+    latestPerRepoOrder.reserve(modules.size());
+    latestPerArchOrder.reserve(modules.size());
+    for (const auto & iter : modules) {
+        latestPerRepoOrder.push_back(iter.second.get());
+        latestPerArchOrder.push_back(iter.first);
+    }
+
+    auto sack = moduleSack;
+    std::sort(latestPerRepoOrder.begin(), latestPerRepoOrder.end(),
+              [sack](const ModulePackage * first, const ModulePackage * second)
+              {return modulePackageLatestPerRepoSorter(sack, first, second);});
+
+    // the same order as used by the HY_PKG_LATEST_PER_ARCH filter
+    Pool * pool = dnf_sack_get_pool(moduleSack);
+    std::sort(latestPerArchOrder.begin(), latestPerArchOrder.end(), [pool](Id first, Id second) {
+        Solvable * a = pool_id2solvable(pool, first);
+        Solvable * b = pool_id2solvable(pool, second);
+        if (a->name != b->name) {
+            return a->name < b->name;
+        }
+        if (a->arch != b->arch) {
+            return a->arch < b->arch;
+        }
+        int cmp = pool_evrcmp(pool, b->evr, a->evr, EVRCMP_COMPARE);
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+        return first < second;
+    });
+    latestOrderModules = modules.size();
+}
+
 std::vector<std::vector<std::vector<ModulePackage *>>>
 ModulePackageContainer::getLatestModulesPerRepo(ModuleState moduleFilter,
     std::vector<ModulePackage *> modulePackages)
@@ -1058,11 +1373,20 @@ ModulePackageContainer::getLatestModulesPerRepo(ModuleState moduleFilter,
         return {};
     }
 
+    // take the packages in the order sorted in advance for all modules
+    pImpl->updateLatestOrder();
+    PackageSet inputModulePackages(pImpl->moduleSack);
+    for (auto modulePackage : modulePackages) {
+        inputModulePackages.set(modulePackage->getId());
+    }
+    modulePackages.clear();
+    for (auto modulePackage : pImpl->latestPerRepoOrder) {
+        if (inputModulePackages.has(modulePackage->getId())) {
+            modulePackages.push_back(modulePackage);
+        }
+    }
+
     std::vector<std::vector<std::vector<ModulePackage *>>> output;
-    auto sack = pImpl->moduleSack;
-    std::sort(modulePackages.begin(), modulePackages.end(),
-              [sack](const ModulePackage * first, const ModulePackage * second)
-              {return modulePackageLatestPerRepoSorter(sack, first, second);});
     auto vectorSize = modulePackages.size();
 
     auto & packageFirst = modulePackages[0];
@@ -1110,28 +1434,40 @@ ModulePackageContainer::getLatestModulesPerRepo(ModuleState moduleFilter,
 std::vector<ModulePackage *>
 ModulePackageContainer::getLatestModules(const std::vector<ModulePackage *> modulePackages, bool activeOnly)
 {
-    // Because modular sovables uses as name combination of module $name:$stream:$context, we can use to get the lates
-    // Query
+    // Because modular sovables uses as name combination of module $name:$stream:$context, the latest modules
+    // are the first ones of each solvable name and arch in latestPerArchOrder
     std::vector<ModulePackage *> latestModules;
-    Query query(pImpl->moduleSack, Query::ExcludeFlags::IGNORE_EXCLUDES);
-    if (activeOnly) {
+    if (activeOnly && !pImpl->activatedModules) {
         // When no active module return
-        if (!pImpl->activatedModules) {
-            return latestModules;
-        }
-        query.addFilter(HY_PKG, HY_EQ, pImpl->activatedModules.get());
+        return latestModules;
     }
+    pImpl->updateLatestOrder();
 
     PackageSet inputModulePackages(pImpl->moduleSack);
     for (auto modulePackage : modulePackages) {
-        inputModulePackages.set(modulePackage->getId());
+        if (!activeOnly || pImpl->activatedModules->has(modulePackage->getId())) {
+            inputModulePackages.set(modulePackage->getId());
+        }
+    }
+
+    Pool * pool = dnf_sack_get_pool(pImpl->moduleSack);
+    PackageSet latest(pImpl->moduleSack);
+    Solvable * highest = nullptr;
+    for (Id moduleId : pImpl->latestPerArchOrder) {
+        if (!inputModulePackages.has(moduleId)) {
+            continue;
+        }
+        Solvable * solvable = pool_id2solvable(pool, moduleId);
+        if (!highest || highest->name != solvable->name || highest->arch != solvable->arch) {
+            highest = solvable;
+        } else if (highest->evr != solvable->evr) {
+            continue;
+        }
+        latest.set(moduleId);
     }
-    query.addFilter(HY_PKG, HY_EQ, &inputModulePackages);
-    query.addFilter(HY_PKG_LATEST_PER_ARCH, HY_EQ, 1);
-    auto set = query.runSet();
 
     Id moduleId = -1;
-    while ((moduleId = set->next(moduleId)) != -1) {
+    while ((moduleId = latest.next(moduleId)) != -1) {
         latestModules.push_back(pImpl->modules.at(moduleId).get());
     }
     return latestModules;
@@ -1412,7 +1748,12 @@ bool ModulePackageContainer::Impl::ModulePersistor::insert(
     auto & parser = newEntry.first->second.first;
     auto & newConfig = newEntry.first->second.second;
 
-    parseConfig(parser, moduleName, path);
+    if (scannedDir == path) {
+        /* All config files of the directory were already inserted */
+        initConfig(parser, moduleName);
+    } else {
+        parseConfig(parser, moduleName, path);
+    }
 
     OptionStringList slist{std::vector<std::string>()};
     const auto &plist = parser.getValue(moduleName, "profiles");
@@ -1425,6 +1766,26 @@ bool ModulePackageContainer::Impl::ModulePersistor::insert(
     return true;
 }
 
+void ModulePackageContainer::Impl::ModulePersistor::insertDirectory(const char *path)
+{
+    std::unique_ptr<DIR> dir(opendir(path));
+    if (dir) {
+        struct dirent * ent;
+        /* Load "*.module" files into module persistor */
+        DIR * dirPtr = dir.get();
+        while ((ent = readdir(dirPtr)) != NULL) {
+            auto filename = ent->d_name;
+            auto fileNameLen = strlen(filename);
+            if (fileNameLen < 8 || strcmp(filename + fileNameLen - 7, ".module")) {
+                continue;
+            }
+            std::string name(filename, fileNameLen - 7);
+            insert(name, path);
+        }
+    }
+    scannedDir = path;
+}
+
 bool ModulePackageContainer::Impl::ModulePersistor::update(const std::string & name)
 {
     bool changed = false;
@@ -1466,18 +1827,24 @@ void ModulePackageContainer::Impl::ModulePersistor::reset(const std::string & na
 void ModulePackageContainer::Impl::ModulePersistor::save(
     const std::string &installRoot, const std::string &modulesPath)
 {
+    std::vector<const std::pair<const std::string, std::pair<ConfigParser, struct Config>> *> changed;
+    for (auto &iter : configs) {
+        if (update(iter.first)) {
+            changed.push_back(&iter);
+        }
+    }
+    if (changed.empty()) {
+        return;
+    }
+
     g_autofree gchar * dirname = g_build_filename(
         installRoot.c_str(), modulesPath.c_str(), "/", NULL);
     makeDirPath(std::string(dirname));
 
-    for (auto &iter : configs) {
-        const auto &name = iter.first;
-
-        if (update(name)) {
-            g_autofree gchar * fname = g_build_filename(installRoot.c_str(),
-                    modulesPath.c_str(), (name + ".module").c_str(), NULL);
-            iter.second.first.write(std::string(fname), false);
-        }
+    for (auto iter : changed) {
+        g_autofree gchar * fname = g_build_filename(installRoot.c_str(),
+                modulesPath.c_str(), (iter->first + ".module").c_str(), NULL);
+        iter->second.first.write(std::string(fname), false);
     }
 }
 
@@ -108,6 +108,13 @@ public:
      */
     void add(DnfSack * sack);
 
+    /**
+     * @brief Can raise ModulePackageContainer::ConflictException
+     *
+     * @param maxThreads Maximal number of threads parsing the metadata, 0 means one per processor
+     */
+    void add(DnfSack * sack, unsigned int maxThreads);
+
     /**
      * @brief Can raise ModulePackageContainer::ConflictException
      *
@@ -148,6 +155,14 @@ public:
 
     std::vector<ModulePackage *> requiresModuleEnablement(const libdnf::PackageSet & packages);
 
+    /**
+    * @brief Adds packages of the sack matching artifacts of active modules to includes. Packages matching
+    * artifacts of inactive modules and packages with the name or a provide of an artifact name of active
+    * modules are added to excludes. Packages matched by each module are kept between calls until
+    * the sack gets new packages, so changing the state of a module only combines them again.
+    */
+    void getModularFilterPackages(DnfSack * sack, libdnf::PackageSet & includes, libdnf::PackageSet & excludes);
+
     /**
     * @brief Enable module stream. Return true if requested change realy triggers a change in
     * the persistor.
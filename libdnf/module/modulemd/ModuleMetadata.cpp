@@ -72,7 +72,7 @@ ModuleMetadata::~ModuleMetadata()
     }
 }
 
-void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priority)
+ModulemdModuleIndex * ModuleMetadata::parseIndex(const std::string & yaml)
 {
     GError *error = NULL;
     g_autoptr(GPtrArray) failures = NULL;
@@ -82,9 +82,22 @@ void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priorit
     if(!success){
         ModuleMetadata::reportFailures(failures);
     }
-    if (error)
+    if (error) {
+        g_object_unref(mi);
         throw ModulePackageContainer::ResolveException( tfm::format(_("Failed to update from string: %s"), error->message));
+    }
+    return mi;
+}
+
+void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priority)
+{
+    ModulemdModuleIndex * mi = parseIndex(yaml);
+    addMetadataFromIndex(mi, priority);
+    g_object_unref(mi);
+}
 
+void ModuleMetadata::addMetadataFromIndex(ModulemdModuleIndex * mi, int priority)
+{
     if (!moduleMerger){
         moduleMerger = modulemd_module_index_merger_new();
         if (resultingModuleIndex){
@@ -95,7 +108,6 @@ void ModuleMetadata::addMetadataFromString(const std::string & yaml, int priorit
     }
 
     modulemd_module_index_merger_associate_index(moduleMerger, mi, priority);
-    g_object_unref(mi);
 }
 
 void ModuleMetadata::resolveAddedMetadata()
@@ -198,7 +210,9 @@ void ModuleMetadata::reportFailures(const GPtrArray *failures)
 {
     for (unsigned int i = 0; i < failures->len; i++) {
         ModulemdSubdocumentInfo * item = (ModulemdSubdocumentInfo *)(g_ptr_array_index(failures, i));
-        std::cerr << "Module yaml error: " << modulemd_subdocument_info_get_gerror(item)->message << "\n";
+        // a single write, metadata of several repositories may be parsed concurrently
+        std::cerr << std::string("Module yaml error: ") +
+            modulemd_subdocument_info_get_gerror(item)->message + "\n";
     }
 }
 
@@ -34,7 +34,11 @@ public:
     ModuleMetadata(const ModuleMetadata & m);
     ModuleMetadata & operator=(const ModuleMetadata & m);
     ~ModuleMetadata();
+    /// Parses module metadata from yaml, the caller owns the returned index
+    static ModulemdModuleIndex * parseIndex(const std::string & yaml);
     void addMetadataFromString(const std::string & yaml, int priority);
+    /// Adds already parsed metadata, the index is shared and not modified
+    void addMetadataFromIndex(ModulemdModuleIndex * index, int priority);
     void resolveAddedMetadata();
     std::vector<ModulePackage *> getAllModulePackages(DnfSack * moduleSack, LibsolvRepo * repo, const std::string & repoID, std::vector<std::tuple<LibsolvRepo *, ModulemdModuleStream *, std::string>> & modulesV2);
     std::map<std::string, std::string> getDefaultStreams();
@@ -22,38 +22,147 @@
 #include "hy-nevra.h"
 #include "dnf-sack.h"
 
-#include "regex/regex.hpp"
+#include <cstdlib>
 
 namespace libdnf {
 
-#define PKG_NAME "([^:(/=<> ]+)"
-#define PKG_EPOCH "(([0-9]+):)?"
-#define PKG_VERSION "([^-:(/=<> ]+)"
-#define PKG_RELEASE PKG_VERSION
-#define PKG_ARCH "([^-:.(/=<> ]+)"
+// Characters which cannot be a part of NEVRA string. The ':' is allowed only as an epoch separator.
+static inline bool isNevraForbidden(char c) noexcept
+{
+    switch (c) {
+        case '(':
+        case '/':
+        case '=':
+        case '<':
+        case '>':
+        case ' ':
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline StringPart makePart(const char * begin, const char * end) noexcept
+{
+    return {begin, static_cast<std::size_t>(end - begin)};
+}
 
-static const Regex NEVRA_FORM_REGEX[]{
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION "-" PKG_RELEASE "\\." PKG_ARCH "$", REG_EXTENDED),
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION "-" PKG_RELEASE          "()"  "$", REG_EXTENDED),
-    Regex("^" PKG_NAME "-" PKG_EPOCH PKG_VERSION        "()"              "()"  "$", REG_EXTENDED),
-    Regex("^" PKG_NAME      "()()"      "()"            "()"     "\\." PKG_ARCH "$", REG_EXTENDED),
-    Regex("^" PKG_NAME      "()()"      "()"            "()"              "()"  "$", REG_EXTENDED)
-};
+/// Splits "[epoch:]version" located in [begin, end). The colon (if any) must be inside the range.
+static bool splitEpochVersion(const char * begin, const char * end, const char * colon,
+                              Nevra::Parts & parts) noexcept
+{
+    if (!colon) {
+        if (begin == end)
+            return false;
+        parts.epoch = Nevra::EPOCH_NOT_SET;
+        parts.version = makePart(begin, end);
+        return true;
+    }
+    if (colon < begin || colon >= end || colon == begin || colon + 1 == end)
+        return false;
+    for (auto it = begin; it != colon; ++it) {
+        if (*it < '0' || *it > '9')
+            return false;
+    }
+    // atoi() stops at the colon
+    parts.epoch = atoi(begin);
+    parts.version = makePart(colon + 1, end);
+    return true;
+}
+
+Nevra::Forms::Forms(const char * nevraStr)
+{
+    static constexpr StringPart EMPTY{"", 0};
+    for (int i = 0; i < HY_FORM_NAME; ++i) {
+        matched[i] = false;
+        parts[i] = {EMPTY, EPOCH_NOT_SET, EMPTY, EMPTY, EMPTY};
+    }
+
+    // single pass: remember the last two dashes, the last dot and the colon
+    const char * lastDash = nullptr;
+    const char * prevDash = nullptr;
+    const char * lastDot = nullptr;
+    const char * colon = nullptr;
+    const char * end = nevraStr;
+    for (; *end != '\0'; ++end) {
+        switch (*end) {
+            case '-':
+                prevDash = lastDash;
+                lastDash = end;
+                break;
+            case '.':
+                lastDot = end;
+                break;
+            case ':':
+                // only one epoch separator is allowed
+                if (colon)
+                    return;
+                colon = end;
+                break;
+            default:
+                if (isNevraForbidden(*end))
+                    return;
+        }
+    }
+    if (end == nevraStr)
+        return;
+
+    // name-[epoch:]version-release.arch and name-[epoch:]version-release
+    if (prevDash && prevDash != nevraStr) {
+        auto & nevr = parts[HY_FORM_NEVR - 1];
+        if (lastDash + 1 != end && splitEpochVersion(prevDash + 1, lastDash, colon, nevr)) {
+            nevr.name = makePart(nevraStr, prevDash);
+            nevr.release = makePart(lastDash + 1, end);
+            matched[HY_FORM_NEVR - 1] = true;
+            if (lastDot && lastDot > lastDash + 1 && lastDot + 1 != end) {
+                auto & nevra = parts[HY_FORM_NEVRA - 1];
+                nevra = nevr;
+                nevra.release = makePart(lastDash + 1, lastDot);
+                nevra.arch = makePart(lastDot + 1, end);
+                matched[HY_FORM_NEVRA - 1] = true;
+            }
+        }
+    }
+
+    // name-[epoch:]version
+    if (lastDash && lastDash != nevraStr) {
+        auto & nev = parts[HY_FORM_NEV - 1];
+        if (splitEpochVersion(lastDash + 1, end, colon, nev)) {
+            nev.name = makePart(nevraStr, lastDash);
+            matched[HY_FORM_NEV - 1] = true;
+        }
+    }
+
+    if (colon)
+        return;
+
+    // name.arch, the arch cannot contain a dash
+    if (lastDot && lastDot != nevraStr && lastDot + 1 != end && (!lastDash || lastDash < lastDot)) {
+        auto & na = parts[HY_FORM_NA - 1];
+        na.name = makePart(nevraStr, lastDot);
+        na.arch = makePart(lastDot + 1, end);
+        matched[HY_FORM_NA - 1] = true;
+    }
+
+    parts[HY_FORM_NAME - 1].name = makePart(nevraStr, end);
+    matched[HY_FORM_NAME - 1] = true;
+}
 
 bool Nevra::parse(const char * nevraStr, HyForm form)
 {
-    enum { NAME = 1, EPOCH = 3, VERSION = 4, RELEASE = 5, ARCH = 6, _LAST_ };
-    auto matchResult = NEVRA_FORM_REGEX[form - 1].match(nevraStr, false, _LAST_);
-    if (!matchResult.isMatched() || matchResult.getMatchedLen(NAME) == 0)
+    return parse(Forms(nevraStr), form);
+}
+
+bool Nevra::parse(const Forms & forms, HyForm form)
+{
+    auto parts = forms.find(form);
+    if (!parts)
         return false;
-    name = matchResult.getMatchedString(NAME);
-    if (matchResult.getMatchedLen(EPOCH) > 0)
-        epoch = atoi(matchResult.getMatchedString(EPOCH).c_str());
-    else
-        epoch = EPOCH_NOT_SET;
-    version = matchResult.getMatchedString(VERSION);
-    release = matchResult.getMatchedString(RELEASE);
-    arch = matchResult.getMatchedString(ARCH);
+    name.assign(parts->name.data, parts->name.size);
+    epoch = parts->epoch;
+    version.assign(parts->version.data, parts->version.size);
+    release.assign(parts->release.data, parts->release.size);
+    arch.assign(parts->arch.data, parts->arch.size);
     return true;
 }
 
@@ -24,18 +24,63 @@
 #include "dnf-types.h"
 #include "hy-subject.h"
 
+#include <cstddef>
 #include <string>
 #include <utility>
 
 namespace libdnf {
 
+/**
+* @brief Non-owning part of a string. Used by the NEVRA and NSVCAP tokenizers to return parsed
+* components without copying them.
+*/
+struct StringPart {
+    const char * data;
+    std::size_t size;
+
+    bool empty() const noexcept { return size == 0; }
+    std::string toString() const { return std::string(data, size); }
+};
+
 struct Nevra {
 public:
     static constexpr int EPOCH_NOT_SET = -1;
 
+    /**
+    * @brief Components of a string matched against one HyForm.
+    * Parts point into the tokenized string. Parts not present in the form are empty.
+    */
+    struct Parts {
+        StringPart name;
+        int epoch;
+        StringPart version;
+        StringPart release;
+        StringPart arch;
+    };
+
+    /**
+    * @brief Splits a string according to all HyForm forms at once.
+    * The string is scanned only once and nothing is allocated. It must outlive the Forms object.
+    */
+    class Forms {
+    public:
+        explicit Forms(const char * nevraStr);
+
+        /**
+        * @brief Returns components of the string for the given form
+        * @return pointer to the components or nullptr if the string does not match the form
+        */
+        const Parts * find(HyForm form) const noexcept;
+
+    private:
+        bool matched[HY_FORM_NAME];
+        Parts parts[HY_FORM_NAME];
+    };
+
     Nevra();
 
     bool parse(const char * nevraStr, HyForm form);
+    bool parse(const Forms & forms, HyForm form);
     void clear() noexcept;
 
     const std::string & getName() const noexcept;
@@ -68,6 +113,12 @@ private:
     std::string arch;
 };
 
+inline const Nevra::Parts * Nevra::Forms::find(HyForm form) const noexcept
+{
+    return form >= HY_FORM_NEVRA && form <= HY_FORM_NAME && matched[form - 1] ?
+           &parts[form - 1] : nullptr;
+}
+
 inline Nevra::Nevra()
 : epoch(EPOCH_NOT_SET) {}
 
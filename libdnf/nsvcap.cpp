@@ -18,56 +18,167 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
-#define HEXADECIMAL DIGITS "abcdef"
-#define MODULE_SPECIAL "+._-"
-#define GLOB "][*?!"
-
 #include "nsvcap.hpp"
 
-#include "libdnf/utils/utils.hpp"
+namespace libdnf {
 
-#include <regex/regex.hpp>
+// [][*?!a-zA-Z0-9+._-]
+static inline bool isModuleNameChar(char c) noexcept
+{
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+        return true;
+    switch (c) {
+        case ']':
+        case '[':
+        case '*':
+        case '?':
+        case '!':
+        case '+':
+        case '.':
+        case '_':
+        case '-':
+            return true;
+        default:
+            return false;
+    }
+}
 
-namespace libdnf {
+// [][*?!0-9-]
+static inline bool isModuleVersionChar(char c) noexcept
+{
+    if (c >= '0' && c <= '9')
+        return true;
+    switch (c) {
+        case ']':
+        case '[':
+        case '*':
+        case '?':
+        case '!':
+        case '-':
+            return true;
+        default:
+            return false;
+    }
+}
+
+namespace {
+
+/// Layout of colon separated tokens: index of the token holding each component, -1 if absent
+struct TokenLayout {
+    int count;
+    int name;
+    int stream;
+    int version;
+    int context;
+    int arch;
+    int empty;  // token which must be empty ("::" separator)
+    HyModuleForm form;
+    HyModuleForm formWithProfile;
+};
+
+}
+
+static constexpr int MAX_MODULE_TOKENS = 6;
 
-#define MODULE_NAME "([" GLOB ASCII_LETTERS DIGITS MODULE_SPECIAL "]+)"
-#define MODULE_STREAM MODULE_NAME
-#define MODULE_VERSION "([" GLOB DIGITS "-]+)"
-#define MODULE_CONTEXT MODULE_NAME
-#define MODULE_ARCH MODULE_NAME
-#define MODULE_PROFILE MODULE_NAME
-
-static const Regex NSVCAP_FORM_REGEX[]{
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT "::?" MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT "::?" MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT       "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION ":" MODULE_CONTEXT       "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM ":" MODULE_VERSION     "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME ":" MODULE_STREAM     "()"               "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"           "::"  MODULE_ARCH "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"           "::"  MODULE_ARCH "\\/?" "()"           "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"                 "()"        "\\/"  MODULE_PROFILE "$", REG_EXTENDED),
-    Regex("^" MODULE_NAME     "()"              "()"               "()"                 "()"        "\\/?" "()"           "$", REG_EXTENDED)
+static const TokenLayout MODULE_LAYOUTS[]{
+    // count, name, stream, version, context, arch, empty
+    {1, 0, -1, -1, -1, -1, -1, HY_MODULE_FORM_N, HY_MODULE_FORM_NP},            // N
+    {2, 0,  1, -1, -1, -1, -1, HY_MODULE_FORM_NS, HY_MODULE_FORM_NSP},          // N:S
+    {3, 0, -1, -1, -1,  2,  1, HY_MODULE_FORM_NA, HY_MODULE_FORM_NAP},          // N::A
+    {3, 0,  1,  2, -1, -1, -1, HY_MODULE_FORM_NSV, HY_MODULE_FORM_NSVP},        // N:S:V
+    {4, 0,  1, -1, -1,  3,  2, HY_MODULE_FORM_NSA, HY_MODULE_FORM_NSAP},        // N:S::A
+    {4, 0,  1,  2,  3, -1, -1, HY_MODULE_FORM_NSVC, HY_MODULE_FORM_NSVCP},      // N:S:V:C
+    {5, 0,  1,  2, -1,  4,  3, HY_MODULE_FORM_NSVA, HY_MODULE_FORM_NSVAP},      // N:S:V::A
+    {5, 0,  1,  2,  3,  4, -1, HY_MODULE_FORM_NSVCA, HY_MODULE_FORM_NSVCAP},    // N:S:V:C:A
+    {6, 0,  1,  2,  3,  5,  4, HY_MODULE_FORM_NSVCA, HY_MODULE_FORM_NSVCAP}     // N:S:V:C::A
 };
 
+Nsvcap::Forms::Forms(const char * nsvcapStr)
+: form(_HY_MODULE_FORM_STOP_)
+{
+    static constexpr StringPart EMPTY{"", 0};
+    parts = {EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY};
+
+    // single pass: split the string into colon separated tokens and a profile
+    StringPart tokens[MAX_MODULE_TOKENS];
+    int tokensCount = 1;
+    const char * tokenBegin = nsvcapStr;
+    const char * slash = nullptr;
+    const char * end = nsvcapStr;
+    for (; *end != '\0'; ++end) {
+        if (*end == ':') {
+            if (slash || tokensCount == MAX_MODULE_TOKENS)
+                return;
+            tokens[tokensCount - 1] = {tokenBegin, static_cast<std::size_t>(end - tokenBegin)};
+            tokenBegin = end + 1;
+            ++tokensCount;
+        } else if (*end == '/') {
+            if (slash)
+                return;
+            slash = end;
+        } else if (!isModuleNameChar(*end)) {
+            return;
+        }
+    }
+    auto prefixEnd = slash ? slash : end;
+    tokens[tokensCount - 1] = {tokenBegin, static_cast<std::size_t>(prefixEnd - tokenBegin)};
+
+    // the number of tokens and the position of the empty one select the layout
+    const TokenLayout * layout = nullptr;
+    for (const auto & candidate : MODULE_LAYOUTS) {
+        if (candidate.count == tokensCount &&
+            (candidate.empty == -1 || tokens[candidate.empty].empty())) {
+            layout = &candidate;
+            break;
+        }
+    }
+    if (!layout)
+        return;
+    for (int i = 0; i < tokensCount; ++i) {
+        if (i != layout->empty && tokens[i].empty())
+            return;
+    }
+    if (layout->version != -1) {
+        const auto & version = tokens[layout->version];
+        for (std::size_t i = 0; i < version.size; ++i) {
+            if (!isModuleVersionChar(version.data[i]))
+                return;
+        }
+    }
+
+    parts.name = tokens[layout->name];
+    if (layout->stream != -1)
+        parts.stream = tokens[layout->stream];
+    if (layout->version != -1)
+        parts.version = tokens[layout->version];
+    if (layout->context != -1)
+        parts.context = tokens[layout->context];
+    if (layout->arch != -1)
+        parts.arch = tokens[layout->arch];
+    if (slash && slash + 1 != end) {
+        parts.profile = {slash + 1, static_cast<std::size_t>(end - slash - 1)};
+        form = layout->formWithProfile;
+    } else {
+        form = layout->form;
+    }
+}
+
 bool Nsvcap::parse(const char *nsvcapStr, HyModuleForm form)
 {
-    enum { NAME = 1, STREAM = 2, VERSION = 3, CONTEXT = 4, ARCH = 5, PROFILE = 6, _LAST_ };
-    auto matchResult = NSVCAP_FORM_REGEX[form - 1].match(nsvcapStr, false, _LAST_);
-    if (!matchResult.isMatched() || matchResult.getMatchedLen(NAME) == 0)
+    return parse(Forms(nsvcapStr), form);
+}
+
+bool Nsvcap::parse(const Forms & forms, HyModuleForm form)
+{
+    auto parts = forms.find(form);
+    if (!parts)
         return false;
-    name = matchResult.getMatchedString(NAME);
-    version = matchResult.getMatchedString(VERSION);
-    stream = matchResult.getMatchedString(STREAM);
-    context = matchResult.getMatchedString(CONTEXT);
-    arch = matchResult.getMatchedString(ARCH);
-    profile = matchResult.getMatchedString(PROFILE);
+    name.assign(parts->name.data, parts->name.size);
+    stream.assign(parts->stream.data, parts->stream.size);
+    version.assign(parts->version.data, parts->version.size);
+    context.assign(parts->context.data, parts->context.size);
+    arch.assign(parts->arch.data, parts->arch.size);
+    profile.assign(parts->profile.data, parts->profile.size);
     return true;
 }
 
@@ -22,6 +22,7 @@
 #define LIBDNF_NSVCAP_HPP
 
 #include "hy-subject.h"
+#include "nevra.hpp"
 
 #include <string>
 
@@ -29,7 +30,46 @@ namespace libdnf {
 
 struct Nsvcap {
 public:
+    /**
+    * @brief Components of a string matched against one HyModuleForm.
+    * Parts point into the tokenized string. Parts not present in the form are empty.
+    */
+    struct Parts {
+        StringPart name;
+        StringPart stream;
+        StringPart version;
+        StringPart context;
+        StringPart arch;
+        StringPart profile;
+    };
+
+    /**
+    * @brief Splits a string according to all HyModuleForm forms at once.
+    * The string is scanned only once and nothing is allocated. A string matches at most one form.
+    * It must outlive the Forms object.
+    */
+    class Forms {
+    public:
+        explicit Forms(const char * nsvcapStr);
+
+        /**
+        * @brief Returns components of the string for the given form
+        * @return pointer to the components or nullptr if the string does not match the form
+        */
+        const Parts * find(HyModuleForm form) const noexcept;
+
+        /**
+        * @brief Returns the form matched by the string or _HY_MODULE_FORM_STOP_ when none matches
+        */
+        HyModuleForm getForm() const noexcept;
+
+    private:
+        HyModuleForm form;
+        Parts parts;
+    };
+
     bool parse(const char *nsvcapStr, HyModuleForm form);
+    bool parse(const Forms & forms, HyModuleForm form);
     void clear();
 
     const std::string & getName() const noexcept;
@@ -62,6 +102,16 @@ private:
     std::string profile;
 };
 
+inline const Nsvcap::Parts * Nsvcap::Forms::find(HyModuleForm form) const noexcept
+{
+    return form != _HY_MODULE_FORM_STOP_ && form == this->form ? &parts : nullptr;
+}
+
+inline HyModuleForm Nsvcap::Forms::getForm() const noexcept
+{
+    return form;
+}
+
 inline const std::string & Nsvcap::getName() const noexcept
 {
     return name;
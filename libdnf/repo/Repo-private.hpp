@@ -73,6 +73,11 @@ struct default_delete<LrHandle> {
     void operator()(LrHandle * ptr) noexcept { lr_handle_free(ptr); }
 };
 
+template<>
+struct default_delete<LrMetadataTarget> {
+    void operator()(LrMetadataTarget * ptr) noexcept { lr_metadatatarget_free(ptr); }
+};
+
 } // namespace std
 
 namespace libdnf {
@@ -85,6 +90,7 @@ public:
     ~Impl();
 
     bool load();
+    static void fetchMetadata(const std::vector<Repo *> & repos);
     bool loadCache(bool throwExcept, bool ignoreMissing=false);
     void downloadMetadata(const std::string & destdir);
     bool isInSync();
@@ -122,6 +128,8 @@ public:
     int maxTimestamp{0};
     bool preserveRemoteTime{false};
     bool fresh{false};
+    // metadata were downloaded by fetchMetadata() and not yet reported by load()
+    bool fetchedInBatch{false};
     std::string repomdFn;
     std::set<std::string> additionalMetadata;
     std::string revision;
@@ -167,6 +175,14 @@ private:
     Repo * owner;
     std::unique_ptr<LrResult> lrHandlePerform(LrHandle * handle, const std::string & destDirectory,
         bool setGPGHomeDir);
+    /// Returns true when load() would download the metadata because there is no usable cache
+    bool needsFetch();
+    /// Creates a temporary directory for downloading the metadata in destdir
+    std::string createFetchTmpDir(const std::string & destdir);
+    /// Replaces metadata in destdir with the ones downloaded in tmpdir
+    void moveFetched(const std::string & destdir, const std::string & tmpdir);
+    /// Loads metadata downloaded to the cache by load() or fetchMetadata()
+    void loadFetched();
     bool isMetalinkInSync();
     bool isRepomdInSync();
     void resetMetadataExpired();
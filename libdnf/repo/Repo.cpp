@@ -372,6 +372,7 @@ std::string Repo::getLocalBaseurl() const
 }
 
 bool Repo::load() { return pImpl->load(); }
+void Repo::fetchMetadata(const std::vector<Repo *> & repos) { Impl::fetchMetadata(repos); }
 bool Repo::loadCache(bool throwExcept, bool ignoreMissing) { return pImpl->loadCache(throwExcept, ignoreMissing); }
 void Repo::downloadMetadata(const std::string & destdir) { pImpl->downloadMetadata(destdir); }
 bool Repo::getUseIncludes() const { return pImpl->useIncludes; }
@@ -968,6 +969,8 @@ bool Repo::Impl::isMetalinkInSync()
     std::unique_ptr<LrHandle> h(lrHandleInitRemote(tmpdir));
 
     handleSetOpt(h.get(), LRO_FETCHMIRRORS, 1L);
+    // only hashes from the metalink are compared, so the fastest mirror is not needed
+    handleSetOpt(h.get(), LRO_FASTESTMIRROR, 0L);
     auto r = lrHandlePerform(h.get(), tmpdir, false);
     LrMetalink * metalink;
     handleGetInfo(h.get(), LRI_METALINK, &metalink);
@@ -1044,7 +1047,10 @@ bool Repo::Impl::isRepomdInSync()
     std::unique_ptr<LrHandle> h(lrHandleInitRemote(tmpdir));
 
     handleSetOpt(h.get(), LRO_YUMDLIST, dlist);
-    auto r = lrHandlePerform(h.get(), tmpdir, conf->repo_gpgcheck().getValue());
+    // The cached repomd was verified when it was downloaded. A matching repomd needs no signature
+    // and a mismatching one is downloaded again with the signature, so skip downloading it here.
+    handleSetOpt(h.get(), LRO_GPGCHECK, 0L);
+    auto r = lrHandlePerform(h.get(), tmpdir, false);
     resultGetInfo(r.get(), LRR_YUM_REPO, &yum_repo);
 
     auto same = haveFilesSameContent(repomdFn.c_str(), yum_repo->repomd);
@@ -1064,9 +1070,8 @@ bool Repo::Impl::isInSync()
 
 
 
-void Repo::Impl::fetch(const std::string & destdir, std::unique_ptr<LrHandle> && h)
+std::string Repo::Impl::createFetchTmpDir(const std::string & destdir)
 {
-    auto repodir = destdir + "/" + METADATA_RELATIVE_DIR;
     if (g_mkdir_with_parents(destdir.c_str(), 0755) == -1) {
         const char * errTxt = strerror(errno);
         throw RepoError(tfm::format(_("Cannot create repo destination directory \"%s\": %s"),
@@ -1078,14 +1083,12 @@ void Repo::Impl::fetch(const std::string & destdir, std::unique_ptr<LrHandle> &&
         throw RepoError(tfm::format(_("Cannot create repo temporary directory \"%s\": %s"),
                                       tmpdir.c_str(), errTxt));
     }
-    Finalizer tmpDirRemover([&tmpdir](){
-        dnf_remove_recursive(tmpdir.c_str(), NULL);
-    });
-    auto tmprepodir = tmpdir + "/" + METADATA_RELATIVE_DIR;
-
-    handleSetOpt(h.get(), LRO_DESTDIR, tmpdir.c_str());
-    auto r = lrHandlePerform(h.get(), tmpdir, conf->repo_gpgcheck().getValue());
+    return tmpdir;
+}
 
+void Repo::Impl::moveFetched(const std::string & destdir, const std::string & tmpdir)
+{
+    auto repodir = destdir + "/" + METADATA_RELATIVE_DIR;
     dnf_remove_recursive(repodir.c_str(), NULL);
     if (g_mkdir_with_parents(repodir.c_str(), 0755) == -1) {
         const char * errTxt = strerror(errno);
@@ -1121,6 +1124,19 @@ void Repo::Impl::fetch(const std::string & destdir, std::unique_ptr<LrHandle> &&
     }
 }
 
+void Repo::Impl::fetch(const std::string & destdir, std::unique_ptr<LrHandle> && h)
+{
+    auto tmpdir = createFetchTmpDir(destdir);
+    Finalizer tmpDirRemover([&tmpdir](){
+        dnf_remove_recursive(tmpdir.c_str(), NULL);
+    });
+
+    handleSetOpt(h.get(), LRO_DESTDIR, tmpdir.c_str());
+    auto r = lrHandlePerform(h.get(), tmpdir, conf->repo_gpgcheck().getValue());
+
+    moveFetched(destdir, tmpdir);
+}
+
 void Repo::Impl::downloadMetadata(const std::string & destdir)
 {
     std::unique_ptr<LrHandle> h(lrHandleInitRemote(nullptr));
@@ -1131,6 +1147,11 @@ void Repo::Impl::downloadMetadata(const std::string & destdir)
 bool Repo::Impl::load()
 {
     auto logger(Log::getLogger());
+    if (fetchedInBatch) {
+        // the metadata were downloaded and loaded by fetchMetadata()
+        fetchedInBatch = false;
+        return true;
+    }
     try {
         if (!getMetadataPath(MD_TYPE_PRIMARY).empty() || loadCache(false)) {
             resetMetadataExpired();
@@ -1154,17 +1175,114 @@ bool Repo::Impl::load()
         logger->debug(tfm::format(_("repo: downloading from remote: %s"), id));
         const auto cacheDir = getCachedir();
         fetch(cacheDir, lrHandleInitRemote(nullptr));
-        timestamp = -1;
-        loadCache(true);
-        fresh = true;
+        loadFetched();
     } catch (const LrExceptionWithSourceUrl & e) {
         auto msg = tfm::format(_("Failed to download metadata for repo '%s': %s"), id, e.what());
         throw RepoError(msg);
     }
-    expired = false;
     return true;
 }
 
+void Repo::Impl::loadFetched()
+{
+    timestamp = -1;
+    loadCache(true);
+    fresh = true;
+    expired = false;
+}
+
+bool Repo::Impl::needsFetch()
+{
+    if (syncStrategy == SyncStrategy::ONLY_CACHE) {
+        return false;
+    }
+    return getMetadataPath(MD_TYPE_PRIMARY).empty() && !loadCache(false);
+}
+
+void Repo::Impl::fetchMetadata(const std::vector<Repo *> & repos)
+{
+    auto logger(Log::getLogger());
+    struct Fetch {
+        Impl * repo;
+        std::unique_ptr<LrHandle> handle;
+        std::unique_ptr<LrMetadataTarget> target;
+        std::string tmpdir;
+    };
+    std::vector<Fetch> fetches;
+    Finalizer tmpDirsRemover([&fetches](){
+        for (auto & fetch : fetches) {
+            dnf_remove_recursive(fetch.tmpdir.c_str(), NULL);
+        }
+    });
+
+    for (auto repo : repos) {
+        auto impl = repo->pImpl.get();
+        try {
+            if (!impl->needsFetch()) {
+                continue;
+            }
+            auto handle = impl->lrHandleInitRemote(nullptr);
+            impl->addCountmeFlag(handle.get());
+            std::string pubringdir;
+            if (impl->conf->repo_gpgcheck().getValue()) {
+                pubringdir = impl->getCachedir() + "/pubring";
+            }
+            GError * errP{nullptr};
+            std::unique_ptr<LrMetadataTarget> target(
+                lr_metadatatarget_new2(handle.get(), nullptr, nullptr, nullptr, nullptr,
+                                       pubringdir.empty() ? nullptr : pubringdir.c_str(), &errP));
+            std::unique_ptr<GError> err(errP);
+            if (err) {
+                throw LrException(err->code, err->message);
+            }
+            fetches.push_back({impl, std::move(handle), std::move(target), ""});
+            fetches.back().tmpdir = impl->createFetchTmpDir(impl->getCachedir());
+            handleSetOpt(fetches.back().handle.get(), LRO_DESTDIR, fetches.back().tmpdir.c_str());
+        } catch (const std::exception & e) {
+            if (!fetches.empty() && fetches.back().repo == impl) {
+                if (!fetches.back().tmpdir.empty()) {
+                    dnf_remove_recursive(fetches.back().tmpdir.c_str(), NULL);
+                }
+                fetches.pop_back();
+            }
+            logger->debug(tfm::format("repo: batch download skipped for '%s': %s", impl->id, e.what()));
+        }
+    }
+    if (fetches.empty()) {
+        return;
+    }
+
+    GSList * list{nullptr};
+    for (auto it = fetches.rbegin(); it != fetches.rend(); ++it) {
+        list = g_slist_prepend(list, it->target.get());
+    }
+    std::unique_ptr<GSList, decltype(&g_slist_free)> listGuard(list, &g_slist_free);
+
+    logger->debug(tfm::format("repo: downloading from remote: %d repos in batch", fetches.size()));
+    GError * errP{nullptr};
+    lr_download_metadata(list, &errP);
+    std::unique_ptr<GError> err(errP);
+    if (err) {
+        logger->debug(tfm::format("repo: batch download failed: %s", err->message));
+        return;
+    }
+
+    for (auto & fetch : fetches) {
+        if (fetch.target->err) {
+            logger->debug(tfm::format("repo: batch download failed for '%s': %s", fetch.repo->id,
+                                      static_cast<const char *>(fetch.target->err->data)));
+            continue;
+        }
+        try {
+            fetch.repo->moveFetched(fetch.repo->getCachedir(), fetch.tmpdir);
+            fetch.repo->loadFetched();
+            fetch.repo->fetchedInBatch = true;
+        } catch (const std::exception & e) {
+            logger->debug(tfm::format("repo: batch download failed for '%s': %s", fetch.repo->id, e.what()));
+        }
+    }
+}
+
 std::string Repo::Impl::getHash() const
 {
     std::string tmp;
@@ -167,6 +167,21 @@ public:
     * @return true if fresh metadata were downloaded, false otherwise.
     */
     bool load();
+    /**
+    * @brief Download metadata of the repos which have no usable cache in one batch
+    *
+    * Transfers of all the repos, including mirrorlist/metalink and repomd downloads, run in
+    * parallel. The metadata are stored in the cache and loaded, the following load() of each
+    * repo returns true without downloading them again. A failure is only logged, load() tries
+    * to download the repo again and reports it. Repos with an expired cache are left to load(),
+    * which checks whether they are in sync.
+    *
+    * Meant to be called with all the enabled repos right before loading them one by one, e.g.
+    * by the Python API (libdnf.repo.Repo.fetchMetadata()) when filling the sack.
+    *
+    * @param repos Repos to download
+    */
+    static void fetchMetadata(const std::vector<Repo *> & repos);
     bool loadCache(bool throwExcept, bool ignoreMissing=false);
     void downloadMetadata(const std::string & destdir);
     bool getUseIncludes() const;
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "packagecolumns.hpp"
+#include "../dnf-sack-private.hpp"
+#include "../hy-iutil-private.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+extern "C" {
+#include <solv/repo.h>
+}
+
+namespace libdnf {
+
+namespace {
+
+const struct {
+    const char * name;
+    PackageColumns::Attribute attribute;
+} ATTRIBUTE_NAMES[] = {
+    {"name", PackageColumns::Attribute::NAME},
+    {"arch", PackageColumns::Attribute::ARCH},
+    {"evr", PackageColumns::Attribute::EVR},
+    {"version", PackageColumns::Attribute::VERSION},
+    {"release", PackageColumns::Attribute::RELEASE},
+    {"reponame", PackageColumns::Attribute::REPONAME},
+    {"vendor", PackageColumns::Attribute::VENDOR},
+    {"summary", PackageColumns::Attribute::SUMMARY},
+    {"license", PackageColumns::Attribute::LICENSE},
+    {"url", PackageColumns::Attribute::URL},
+    {"sourcerpm", PackageColumns::Attribute::SOURCERPM},
+    {"location", PackageColumns::Attribute::LOCATION},
+    {"epoch", PackageColumns::Attribute::EPOCH},
+    {"downloadsize", PackageColumns::Attribute::DOWNLOADSIZE},
+    {"installsize", PackageColumns::Attribute::INSTALLSIZE},
+    {"buildtime", PackageColumns::Attribute::BUILDTIME},
+    {"installtime", PackageColumns::Attribute::INSTALLTIME},
+};
+
+/// Table of distinct strings. Strings interned in the pool are looked up by their Id, so the
+/// common attributes are not hashed for every package.
+class StringTable {
+public:
+    explicit StringTable(std::vector<std::string> & strings) : strings(strings) { add(""); }
+
+    uint32_t add(const char * str)
+    {
+        if (!str)
+            str = "";
+        auto it = byValue.find(str);
+        if (it != byValue.end())
+            return it->second;
+        auto index = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(str);
+        byValue.emplace(strings.back(), index);
+        return index;
+    }
+
+    uint32_t addPoolId(Pool * pool, Id id)
+    {
+        auto it = byPoolId.find(id);
+        if (it != byPoolId.end())
+            return it->second;
+        auto index = add(id ? pool_id2str(pool, id) : nullptr);
+        byPoolId.emplace(id, index);
+        return index;
+    }
+
+private:
+    std::vector<std::string> & strings;
+    std::unordered_map<std::string, uint32_t> byValue;
+    std::unordered_map<Id, uint32_t> byPoolId;
+};
+
+uint64_t
+numericValue(Pool * pool, Solvable * s, PackageColumns::Attribute attribute)
+{
+    switch (attribute) {
+        case PackageColumns::Attribute::EPOCH:
+            return pool_get_epoch(pool, pool_id2str(pool, s->evr));
+        case PackageColumns::Attribute::DOWNLOADSIZE:
+            return solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0);
+        case PackageColumns::Attribute::INSTALLSIZE:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0);
+        case PackageColumns::Attribute::BUILDTIME:
+            return solvable_lookup_num(s, SOLVABLE_BUILDTIME, 0);
+        case PackageColumns::Attribute::INSTALLTIME:
+            return solvable_lookup_num(s, SOLVABLE_INSTALLTIME, 0);
+        default:
+            return 0;
+    }
+}
+
+uint32_t
+stringValue(Pool * pool, Solvable * s, PackageColumns::Attribute attribute, StringTable & table)
+{
+    switch (attribute) {
+        case PackageColumns::Attribute::NAME:
+            return table.addPoolId(pool, s->name);
+        case PackageColumns::Attribute::ARCH:
+            return table.addPoolId(pool, s->arch);
+        case PackageColumns::Attribute::EVR:
+            return table.addPoolId(pool, s->evr);
+        case PackageColumns::Attribute::VENDOR:
+            return table.addPoolId(pool, s->vendor);
+        case PackageColumns::Attribute::VERSION:
+        case PackageColumns::Attribute::RELEASE: {
+            char *e, *v, *r;
+            pool_split_evr(pool, pool_id2str(pool, s->evr), &e, &v, &r);
+            return table.add(attribute == PackageColumns::Attribute::VERSION ? v : r);
+        }
+        case PackageColumns::Attribute::REPONAME:
+            return table.add(s->repo->name);
+        case PackageColumns::Attribute::SUMMARY:
+            return table.add(solvable_lookup_str(s, SOLVABLE_SUMMARY));
+        case PackageColumns::Attribute::LICENSE:
+            return table.add(solvable_lookup_str(s, SOLVABLE_LICENSE));
+        case PackageColumns::Attribute::URL:
+            return table.add(solvable_lookup_str(s, SOLVABLE_URL));
+        case PackageColumns::Attribute::SOURCERPM:
+            return table.add(solvable_lookup_sourcepkg(s));
+        case PackageColumns::Attribute::LOCATION:
+            return table.add(solvable_get_location(s, nullptr));
+        default:
+            return 0;
+    }
+}
+
+}
+
+bool
+PackageColumns::attributeFromName(const char * name, Attribute & attribute)
+{
+    for (auto & item : ATTRIBUTE_NAMES) {
+        if (strcmp(item.name, name) == 0) {
+            attribute = item.attribute;
+            return true;
+        }
+    }
+    return false;
+}
+
+PackageColumns::PackageColumns(const PackageSet & pset, const std::vector<Attribute> & attributes)
+: stringColumns(attributes.size()), numericColumns(attributes.size())
+{
+    Pool * pool = dnf_sack_get_pool(pset.getSack());
+    StringTable table(strings);
+
+    ids.reserve(pset.size());
+    Id id = -1;
+    while ((id = pset.next(id)) != -1)
+        ids.push_back(id);
+
+    for (size_t i = 0; i < attributes.size(); ++i) {
+        if (isNumeric(attributes[i]))
+            numericColumns[i].reserve(ids.size());
+        else
+            stringColumns[i].reserve(ids.size());
+    }
+
+    for (auto pkgId : ids) {
+        Solvable * s = pool_id2solvable(pool, pkgId);
+        repo_internalize_trigger(s->repo);
+        for (size_t i = 0; i < attributes.size(); ++i) {
+            if (isNumeric(attributes[i]))
+                numericColumns[i].push_back(numericValue(pool, s, attributes[i]));
+            else
+                stringColumns[i].push_back(stringValue(pool, s, attributes[i], table));
+        }
+    }
+}
+
+}
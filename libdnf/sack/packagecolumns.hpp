@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __PACKAGE_COLUMNS_HPP
+#define __PACKAGE_COLUMNS_HPP
+
+#include "packageset.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libdnf {
+
+/// Attributes of a set of packages exported column by column
+///
+/// Every column has one row per package, the rows are ordered by package Id (see getIds()).
+/// String attributes are stored as indexes into a single table of distinct strings shared by
+/// all string columns, a missing value is stored as an index to the empty string. Numeric
+/// attributes are stored as 64 bit numbers.
+class PackageColumns {
+public:
+    enum class Attribute {
+        // string attributes
+        NAME, ARCH, EVR, VERSION, RELEASE, REPONAME, VENDOR, SUMMARY, LICENSE, URL, SOURCERPM,
+        LOCATION,
+        // numeric attributes
+        EPOCH, DOWNLOADSIZE, INSTALLSIZE, BUILDTIME, INSTALLTIME
+    };
+
+    /// Looks up an attribute by its lower case name, e.g. "reponame"
+    /// @return false if there is no such attribute
+    static bool attributeFromName(const char * name, Attribute & attribute);
+    static bool isNumeric(Attribute attribute) noexcept { return attribute >= Attribute::EPOCH; }
+
+    PackageColumns(const PackageSet & pset, const std::vector<Attribute> & attributes);
+
+    size_t size() const noexcept { return ids.size(); }
+    const std::vector<Id> & getIds() const noexcept { return ids; }
+    const std::vector<std::string> & getStrings() const noexcept { return strings; }
+    /// Returns column of indexes into getStrings() of the index-th requested attribute
+    const std::vector<uint32_t> & getStringColumn(size_t index) const { return stringColumns.at(index); }
+    /// Returns column of numbers of the index-th requested attribute
+    const std::vector<uint64_t> & getNumericColumn(size_t index) const { return numericColumns.at(index); }
+
+private:
+    std::vector<Id> ids;
+    std::vector<std::string> strings;
+    // indexed by position of the attribute in the request, only the matching kind is filled
+    std::vector<std::vector<uint32_t>> stringColumns;
+    std::vector<std::vector<uint64_t>> numericColumns;
+};
+
+}
+
+#endif // __PACKAGE_COLUMNS_HPP
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <fnmatch.h>
 #include <vector>
 
@@ -41,11 +42,13 @@ extern "C" {
 #include "../dnf-sack-private.hpp"
 #include "../dnf-advisorypkg.h"
 #include "../dnf-advisory-private.hpp"
+#include "../error.hpp"
 #include "../goal/IdQueue.hpp"
 #include "../goal/Goal-private.hpp"
 #include "advisory.hpp"
 #include "advisorypkg.hpp"
 #include "packageset.hpp"
+#include "querycache.hpp"
 
 #include "libdnf/repo/solvable/Dependency.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
@@ -780,6 +783,50 @@ int Filter::getCmpType() const noexcept { return pImpl->cmpType; }
 int Filter::getMatchType() const noexcept { return pImpl->matchType; }
 const std::vector< _Match >& Filter::getMatches() const noexcept { return pImpl->matches; }
 
+/// How the outcome of a filter for one package depends on the other packages in the query
+enum class FilterDependency {
+    /// outcome is decided for each package separately
+    PACKAGE,
+    /// outcome does not depend on the query result at all
+    NONE,
+    /// outcome depends on the other packages in the query result
+    RESULT
+};
+
+static FilterDependency
+filterDependency(const Filter & f)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG:
+        case HY_PKG_ALL:
+        case HY_PKG_EMPTY:
+        case HY_PKG_PROVIDES:
+            return FilterDependency::NONE;
+        case HY_PKG_CONFLICTS:
+        case HY_PKG_ENHANCES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+            return f.getMatchType() == _HY_RELDEP ? FilterDependency::PACKAGE : FilterDependency::NONE;
+        case HY_PKG_ADVISORY:
+        case HY_PKG_ADVISORY_BUG:
+        case HY_PKG_ADVISORY_CVE:
+        case HY_PKG_ADVISORY_SEVERITY:
+        case HY_PKG_ADVISORY_TYPE:
+        case HY_PKG_LATEST:
+        case HY_PKG_LATEST_PER_ARCH:
+        case HY_PKG_LATEST_PER_ARCH_BY_PRIORITY:
+        case HY_PKG_DOWNGRADABLE:
+        case HY_PKG_UPGRADABLE:
+        case HY_PKG_UPGRADES_BY_PRIORITY:
+        case HY_PKG_OBSOLETES_BY_PRIORITY:
+            return FilterDependency::RESULT;
+        default:
+            return FilterDependency::PACKAGE;
+    }
+}
+
 class Query::Impl {
 public:
     ~Impl();
@@ -793,7 +840,23 @@ private:
     Query::ExcludeFlags flags;
     std::unique_ptr<PackageSet> result;
     std::vector<Filter> filters;
-    void apply();
+    std::vector<FilterProfile> profile;
+    void apply(bool profiling = false);
+    void applyFilter(const Filter & f, Map *m);
+    std::string getSignature() const;
+    bool isCached() const;
+
+    /**
+    * @brief Evaluates filters lazily until `limit` matching packages are found.
+    * Filters which depend on the whole query result are applied first. The following filters are
+    * evaluated on growing blocks of candidates so the evaluation can stop early. When all candidates
+    * were evaluated the query becomes applied, otherwise the not yet applied filters are kept.
+    *
+    * @param limit Number of packages to find
+    * @param out If not nullptr, found packages are appended to it
+    * @return std::size_t Number of found packages, at most `limit`
+    */
+    std::size_t applyLazy(std::size_t limit, std::vector<Id> * out);
     Map *considered_cached = nullptr;
 
     /**
@@ -850,6 +913,7 @@ Query::Impl::Impl(const Query::Impl & src)
 , sack(src.sack)
 , flags(src.flags)
 , filters(src.filters)
+, profile(src.profile)
 {
     if (src.result) {
         result.reset(new PackageSet(*src.result.get()));
@@ -863,6 +927,7 @@ Query::Impl::operator=(const Query::Impl & src)
     sack = src.sack;
     flags = src.flags;
     filters = src.filters;
+    profile = src.profile;
     if (src.result) {
         result.reset(new PackageSet(*src.result.get()));
     } else {
@@ -901,6 +966,7 @@ Query::clear()
     pImpl->applied = false;
     pImpl->result.reset();
     pImpl->filters.clear();
+    pImpl->profile.clear();
 }
 
 size_t
@@ -1305,6 +1371,139 @@ Query::Impl::filterRcoReldep(const Filter & f, Map *m)
     queue_free(&rco);
 }
 
+/**
+* @brief Sets in the map packages of the set which satisfy the predicate
+*
+* Filters select a predicate specialized for their comparison type once, so the loop over packages
+* does not branch on it.
+*/
+template <typename Predicate>
+static void
+filterSolvables(Pool * pool, const PackageSet * pset, Map * m, Predicate predicate)
+{
+    Id id = -1;
+    while (true) {
+        id = pset->next(id);
+        if (id == -1)
+            break;
+        if (predicate(pool_id2solvable(pool, id)))
+            MAPSET(m, id);
+    }
+}
+
+/// Result of a three-way comparison accepted by the HY_GT, HY_LT and HY_EQ bits of cmp_type
+template <bool GT, bool LT, bool EQ>
+struct OrderMatch {
+    bool operator()(int cmp) const { return (GT && cmp > 0) || (LT && cmp < 0) || (EQ && cmp == 0); }
+};
+
+/**
+* @brief Calls kernel with the OrderMatch instance for the ordering bits of cmp_type. Nothing
+* matches when there are no ordering bits.
+*/
+template <typename Kernel>
+static void
+dispatchOrder(int cmpType, const Kernel & kernel)
+{
+    switch (cmpType & (HY_GT | HY_LT | HY_EQ)) {
+        case HY_EQ:
+            kernel(OrderMatch<false, false, true>());
+            break;
+        case HY_GT:
+            kernel(OrderMatch<true, false, false>());
+            break;
+        case HY_LT:
+            kernel(OrderMatch<false, true, false>());
+            break;
+        case HY_GT | HY_EQ:
+            kernel(OrderMatch<true, false, true>());
+            break;
+        case HY_LT | HY_EQ:
+            kernel(OrderMatch<false, true, true>());
+            break;
+        case HY_GT | HY_LT:
+            kernel(OrderMatch<true, true, false>());
+            break;
+        case HY_GT | HY_LT | HY_EQ:
+            kernel(OrderMatch<true, true, true>());
+            break;
+        default:
+            break;
+    }
+}
+
+struct GlobMatch {
+    int flags;
+    bool operator()(const char * value, const char * pattern) const
+    {
+        return fnmatch(pattern, value, flags) == 0;
+    }
+};
+
+struct SubstrMatch {
+    bool operator()(const char * value, const char * pattern) const
+    {
+        return strstr(value, pattern) != NULL;
+    }
+};
+
+struct SubstrIcaseMatch {
+    bool operator()(const char * value, const char * pattern) const
+    {
+        return strcasestr(value, pattern) != NULL;
+    }
+};
+
+struct EqIcaseMatch {
+    bool operator()(const char * value, const char * pattern) const
+    {
+        return strcasecmp(value, pattern) == 0;
+    }
+};
+
+/**
+* @brief Calls kernel with the string match for cmp_type of a filter which resolves case sensitive
+* HY_EQ by ids. Nothing matches for other comparison types.
+*/
+template <typename Kernel>
+static void
+dispatchStringMatch(int cmpType, const Kernel & kernel)
+{
+    if (cmpType & HY_ICASE) {
+        if (cmpType & HY_SUBSTR)
+            kernel(SubstrIcaseMatch());
+        else if (cmpType & HY_EQ)
+            kernel(EqIcaseMatch());
+        else if (cmpType & HY_GLOB)
+            kernel(GlobMatch{FNM_CASEFOLD});
+    } else if (cmpType & HY_GLOB) {
+        kernel(GlobMatch{0});
+    } else if (cmpType & HY_SUBSTR) {
+        kernel(SubstrMatch());
+    }
+}
+
+/// Matches a string pattern against a string attribute of packages
+struct StrAttrKernel {
+    Pool * pool;
+    const PackageSet * pset;
+    Map * m;
+    const char * match;
+    /// attribute of the package (Solvable::name or Solvable::arch)
+    Id Solvable::*attr;
+
+    template <typename StringMatch>
+    void operator()(StringMatch stringMatch) const
+    {
+        auto pool = this->pool;
+        auto match = this->match;
+        auto attr = this->attr;
+        filterSolvables(pool, pset, m, [=](Solvable * s) {
+            return stringMatch(pool_id2str(pool, s->*attr), match);
+        });
+    }
+};
+
 void
 Query::Impl::filterName(const Filter & f, Map *m)
 {
@@ -1355,50 +1554,33 @@ Query::Impl::filterName(const Filter & f, Map *m)
         }
         return;
     }
-    
+
     for (auto match_union : f.getMatches()) {
-        const char *match = match_union.str;
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
+        dispatchStringMatch(cmpType,
+                            StrAttrKernel{pool, resultPset, m, match_union.str, &Solvable::name});
+    }
+}
 
-            Solvable *s = pool_id2solvable(pool, id);
-            if (cmpType & HY_ICASE) {
-                const char *name = pool_id2str(pool, s->name);
-                if (cmpType & HY_SUBSTR) {
-                    if (strcasestr(name, match) != NULL)
-                        MAPSET(m, id);
-                    continue;
-                }
-                if (cmpType & HY_EQ) {
-                    if (strcasecmp(name, match) == 0)
-                        MAPSET(m, id);
-                    continue;
-                }
-                if (cmpType & HY_GLOB) {
-                    if (fnmatch(match, name, FNM_CASEFOLD) == 0)
-                        MAPSET(m, id);
-                    continue;
-                }
-                continue;
-            }
+/// Compares epochs of packages with the epoch of the filter
+struct EpochKernel {
+    Pool * pool;
+    const PackageSet * pset;
+    Map * m;
+    unsigned long epoch;
 
-            const char *name = pool_id2str(pool, s->name);
-            if (cmpType & HY_GLOB) {
-                if (fnmatch(match, name, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
-            if (cmpType & HY_SUBSTR) {
-                if (strstr(name, match) != NULL)
-                    MAPSET(m, id);
-                continue;
-            }
-        }
+    template <typename Order>
+    void operator()(Order order) const
+    {
+        auto pool = this->pool;
+        auto epoch = this->epoch;
+        filterSolvables(pool, pset, m, [=](Solvable * s) {
+            if (s->evr == ID_EMPTY)
+                return false;
+            unsigned long pkg_epoch = pool_get_epoch(pool, pool_id2str(pool, s->evr));
+            return order((pkg_epoch > epoch) - (pkg_epoch < epoch));
+        });
     }
-}
+};
 
 void
 Query::Impl::filterEpoch(const Filter & f, Map *m)
@@ -1409,27 +1591,27 @@ Query::Impl::filterEpoch(const Filter & f, Map *m)
 
     for (auto match : f.getMatches()) {
         unsigned long epoch = match.num;
+        dispatchOrder(cmp_type, EpochKernel{pool, resultPset, m, epoch});
+    }
+}
 
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-
-            Solvable *s = pool_id2solvable(pool, id);
-            if (s->evr == ID_EMPTY)
-                continue;
-
-            const char *evr = pool_id2str(pool, s->evr);
-            unsigned long pkg_epoch = pool_get_epoch(pool, evr);
+/// Compares EVRs of packages with the EVR of the filter
+struct EvrKernel {
+    Pool * pool;
+    const PackageSet * pset;
+    Map * m;
+    Id evr;
 
-            if ((pkg_epoch > epoch && cmp_type & HY_GT) ||
-                (pkg_epoch < epoch && cmp_type & HY_LT) ||
-                (pkg_epoch == epoch && cmp_type & HY_EQ))
-                MAPSET(m, id);
-        }
+    template <typename Order>
+    void operator()(Order order) const
+    {
+        auto pool = this->pool;
+        auto evr = this->evr;
+        filterSolvables(pool, pset, m, [=](Solvable * s) {
+            return order(pool_evrcmp(pool, s->evr, evr, EVRCMP_COMPARE));
+        });
     }
-}
+};
 
 void
 Query::Impl::filterEvr(const Filter & f, Map *m)
@@ -1440,20 +1622,7 @@ Query::Impl::filterEvr(const Filter & f, Map *m)
 
     for (auto match : f.getMatches()) {
         Id match_evr = pool_str2id(pool, match.str, 1);
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable *s = pool_id2solvable(pool, id);
-            int cmp = pool_evrcmp(pool, s->evr, match_evr, EVRCMP_COMPARE);
-
-            if ((cmp > 0 && cmp_type & HY_GT) || (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
-                MAPSET(m, id);
-            }
-        }
+        dispatchOrder(cmp_type, EvrKernel{pool, resultPset, m, match_evr});
     }
 }
 
@@ -1495,6 +1664,61 @@ Query::Impl::filterNevra(const Filter & f, Map *m)
     }
 }
 
+/// Part of EVR compared by filterVersion() and filterRelease()
+enum class EvrPart { VERSION, RELEASE };
+
+/**
+* @brief Matches the version or release of packages with the filter. Glob patterns are matched
+* directly, ordering comparisons are done on "<version>-0" or "0-<release>".
+*/
+template <EvrPart part>
+struct VersionReleaseKernel {
+    Pool * pool;
+    const PackageSet * pset;
+    Map * m;
+    const char * match;
+
+    /// Returns version or release of the package, or nullptr for packages without EVR
+    static const char * getPart(Pool * pool, Solvable * s)
+    {
+        if (s->evr == ID_EMPTY)
+            return nullptr;
+        char *e, *v, *r;
+        pool_split_evr(pool, pool_id2str(pool, s->evr), &e, &v, &r);
+        return part == EvrPart::VERSION ? v : r;
+    }
+
+    static const char * join(Pool * pool, const char * value)
+    {
+        return part == EvrPart::VERSION ? pool_tmpjoin(pool, value, "-0", NULL)
+                                        : pool_tmpjoin(pool, "0-", value, NULL);
+    }
+
+    void operator()(GlobMatch glob) const
+    {
+        auto pool = this->pool;
+        auto match = this->match;
+        filterSolvables(pool, pset, m, [=](Solvable * s) {
+            auto value = getPart(pool, s);
+            return value && glob(value, match);
+        });
+    }
+
+    template <typename Order>
+    void operator()(Order order) const
+    {
+        auto pool = this->pool;
+        char * filter_vr = part == EvrPart::VERSION ? solv_dupjoin(match, "-0", NULL)
+                                                   : solv_dupjoin("0-", match, NULL);
+        filterSolvables(pool, pset, m, [=](Solvable * s) {
+            auto value = getPart(pool, s);
+            return value &&
+                order(pool_evrcmp_str(pool, join(pool, value), filter_vr, EVRCMP_COMPARE));
+        });
+        solv_free(filter_vr);
+    }
+};
+
 void
 Query::Impl::filterVersion(const Filter & f, Map *m)
 {
@@ -1503,37 +1727,11 @@ Query::Impl::filterVersion(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-        char *filter_vr = solv_dupjoin(match, "-0", NULL);
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            char *e, *v, *r;
-            Solvable *s = pool_id2solvable(pool, id);
-            if (s->evr == ID_EMPTY)
-                continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
-
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, v, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
-
-            char *vr = pool_tmpjoin(pool, v, "-0", NULL);
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
-            if ((cmp > 0 && cmp_type & HY_GT) ||
-                (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
-                MAPSET(m, id);
-            }
-        }
-        solv_free(filter_vr);
+        VersionReleaseKernel<EvrPart::VERSION> kernel{pool, resultPset, m, match_in.str};
+        if (cmp_type & HY_GLOB)
+            kernel(GlobMatch{0});
+        else
+            dispatchOrder(cmp_type, kernel);
     }
 }
 
@@ -1545,39 +1743,11 @@ Query::Impl::filterRelease(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-        char *filter_vr = solv_dupjoin("0-", match, NULL);
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            char *e, *v, *r;
-            Solvable *s = pool_id2solvable(pool, id);
-            if (s->evr == ID_EMPTY)
-                continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
-
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, r, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
-
-            char *vr = pool_tmpjoin(pool, "0-", r, NULL);
-
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
-
-            if ((cmp > 0 && cmp_type & HY_GT) ||
-                (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
-                MAPSET(m, id);
-            }
-        }
-        solv_free(filter_vr);
+        VersionReleaseKernel<EvrPart::RELEASE> kernel{pool, resultPset, m, match_in.str};
+        if (cmp_type & HY_GLOB)
+            kernel(GlobMatch{0});
+        else
+            dispatchOrder(cmp_type, kernel);
     }
 }
 
@@ -1586,34 +1756,19 @@ Query::Impl::filterArch(const Filter & f, Map *m)
 {
     Pool *pool = dnf_sack_get_pool(sack);
     int cmp_type = f.getCmpType();
-    Id match_arch_id = 0;
     auto resultPset = result.get();
 
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
         if (cmp_type & HY_EQ) {
-            match_arch_id = pool_str2id(pool, match, 0);
+            Id match_arch_id = pool_str2id(pool, match, 0);
             if (match_arch_id == 0)
                 continue;
-        }
-
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable *s = pool_id2solvable(pool, id);
-            if (cmp_type & HY_EQ) {
-                if (match_arch_id == s->arch)
-                    MAPSET(m, id);
-                continue;
-            }
-            const char *arch = pool_id2str(pool, s->arch);
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, arch, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
+            filterSolvables(pool, resultPset, m, [=](Solvable * s) {
+                return s->arch == match_arch_id;
+            });
+        } else if (cmp_type & HY_GLOB) {
+            StrAttrKernel{pool, resultPset, m, match, &Solvable::arch}(GlobMatch{0});
         }
     }
 }
@@ -1640,11 +1795,10 @@ Query::Impl::filterSourcerpm(const Filter & f, Map *m)
             if (!g_str_has_prefix(match, name)) // early check
                 continue;
 
-            DnfPackage *pkg = dnf_package_new(sack, id);
-            const char *srcrpm = dnf_package_get_sourcerpm(pkg);
+            repo_internalize_trigger(s->repo);
+            const char *srcrpm = solvable_lookup_sourcepkg(s);
             if (srcrpm && !strcmp(match, srcrpm))
                 MAPSET(m, id);
-            g_object_unref(pkg);
         }
     }
 }
@@ -2103,11 +2257,10 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
     Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
-    dnf_sack_make_provides_ready(sack);
-
     if (!pool->installed) {
         return;
     }
+    auto & updown = dnf_sack_get_updown_index(sack);
 
     for (auto match_in : f.getMatches()) {
         if (match_in.num == 0)
@@ -2118,13 +2271,10 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
             id = resultPset->next(id);
             if (id == -1)
                 break;
-            Solvable *s = pool_id2solvable(pool, id);
-            if (s->repo == pool->installed)
-                continue;
             if (f.getKeyname() == HY_PKG_DOWNGRADES) {
-                if (what_downgrades(pool, id) > 0)
+                if (updown.downgrades(id) > 0)
                     MAPSET(m, id);
-            } else if (what_upgrades(pool, id) > 0)
+            } else if (updown.upgrades(id) > 0)
                 MAPSET(m, id);
         }
     }
@@ -2136,11 +2286,11 @@ Query::Impl::filterUpdownByPriority(const Filter & f, Map *m)
     Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
-    dnf_sack_make_provides_ready(sack);
     auto repoInstalled = pool->installed;
     if (!repoInstalled) {
         return;
     }
+    auto & updown = dnf_sack_get_updown_index(sack);
 
     for (auto match_in : f.getMatches()) {
         if (match_in.num == 0)
@@ -2165,12 +2315,12 @@ Query::Impl::filterUpdownByPriority(const Filter & f, Map *m)
                 name = candidate->name;
                 priority = candidate->repo->priority;
                 id = pool_solvable2id(pool, candidate);
-                if (what_upgrades(pool, id) > 0) {
+                if (updown.upgrades(id) > 0) {
                     MAPSET(m, id);
                 }
             } else if (priority == candidate->repo->priority) {
                 id = pool_solvable2id(pool, candidate);
-                if (what_upgrades(pool, id) > 0) {
+                if (updown.upgrades(id) > 0) {
                     MAPSET(m, id);
                 }
             }
@@ -2185,11 +2335,10 @@ Query::Impl::filterUpdownAble(const Filter  &f, Map *m)
     Solvable *s;
     Pool *pool = dnf_sack_get_pool(sack);
 
-    dnf_sack_make_provides_ready(sack);
-
     if (!pool->installed) {
         return;
     }
+    auto & updown = dnf_sack_get_updown_index(sack);
     auto resultMap = result->getMap();
 
     for (auto match_in : f.getMatches()) {
@@ -2208,8 +2357,8 @@ Query::Impl::filterUpdownAble(const Filter  &f, Map *m)
             if (s->repo == pool->installed)
                 continue;
 
-            what = (f.getKeyname() == HY_PKG_DOWNGRADABLE) ? what_downgrades(pool, p) :
-                what_upgrades(pool, p);
+            what = (f.getKeyname() == HY_PKG_DOWNGRADABLE) ? updown.downgrades(p) :
+                updown.upgrades(p);
             if (what != 0 && map_tst(resultMap, what))
                 map_set(m, what);
         }
@@ -2302,11 +2451,114 @@ void
 Query::apply() { pImpl->apply(); }
 
 void
-Query::Impl::apply()
+Query::apply(bool profile) { pImpl->apply(profile); }
+
+const std::vector<FilterProfile> &
+Query::explain()
+{
+    if (pImpl->applied) {
+        throw Error("Query is already applied, filters to explain are not available");
+    }
+    pImpl->apply(true);
+    return pImpl->profile;
+}
+
+const std::vector<FilterProfile> &
+Query::getProfile() const noexcept { return pImpl->profile; }
+
+bool
+Query::isCached() const { return pImpl->isCached(); }
+
+/// Appends raw bytes of the value to the signature
+template<typename T>
+static void
+appendSignature(std::string & signature, const T & value)
+{
+    signature.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/**
+* @brief Returns key of the query result in QueryCache. Queries with equal exclude flags and
+* equal filters in the same order have equal signatures.
+*/
+std::string
+Query::Impl::getSignature() const
+{
+    std::string signature;
+    appendSignature(signature, static_cast<int>(flags));
+    for (auto & f : filters) {
+        appendSignature(signature, f.getKeyname());
+        appendSignature(signature, f.getCmpType());
+        appendSignature(signature, f.getMatchType());
+        auto & matches = f.getMatches();
+        appendSignature(signature, matches.size());
+        for (auto & match : matches) {
+            switch (f.getMatchType()) {
+                case _HY_NUM:
+                    appendSignature(signature, match.num);
+                    break;
+                case _HY_RELDEP:
+                    appendSignature(signature, match.reldep);
+                    break;
+                case _HY_STR: {
+                    std::size_t len = strlen(match.str);
+                    appendSignature(signature, len);
+                    signature.append(match.str, len);
+                    break;
+                }
+                case _HY_PKG: {
+                    // equal sets may differ in the size of the map, trailing zeros are skipped
+                    auto map = match.pset->getMap();
+                    int size = map->size;
+                    while (size > 0 && map->map[size - 1] == 0)
+                        --size;
+                    appendSignature(signature, size);
+                    signature.append(reinterpret_cast<const char *>(map->map), size);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+    return signature;
+}
+
+/// Returns true when apply() takes the result from the cache of the sack
+bool
+Query::Impl::isCached() const
+{
+    if (applied || result)
+        return false;
+    auto cache = dnf_sack_get_query_cache(sack);
+    return cache && cache->find(getSignature(), dnf_sack_get_generation(sack));
+}
+
+void
+Query::Impl::apply(bool profiling)
 {
     if (applied)
         return;
 
+    // only a result computed from all packages of the sack is determined by the signature
+    QueryCache * cache = nullptr;
+    std::string signature;
+    if (!result && !profiling) {
+        cache = dnf_sack_get_query_cache(sack);
+        if (cache) {
+            signature = getSignature();
+            if (auto cached = cache->find(signature, dnf_sack_get_generation(sack))) {
+                result.reset(new PackageSet(*cached));
+                applied = true;
+                filters.clear();
+                return;
+            }
+        }
+    }
+
+    if (profiling)
+        profile.clear();
+
     Pool *pool = dnf_sack_get_pool(sack);
     repo_internalize_all_trigger(pool);
     Map m;
@@ -2315,107 +2567,223 @@ Query::Impl::apply()
     map_init(&m, pool->nsolvables);
     map_grow(result->getMap(), pool->nsolvables);
     for (auto f : filters) {
-        map_empty(&m);
-        switch (f.getKeyname()) {
-            case HY_PKG:
-                filterPkg(f, &m);
-                break;
-            case HY_PKG_ALL:
-            case HY_PKG_EMPTY:
-                /* used to set query empty by keeping Map m empty */
-                break;
-            case HY_PKG_NAME:
-                filterName(f, &m);
-                break;
-            case HY_PKG_EPOCH:
-                filterEpoch(f, &m);
-                break;
-            case HY_PKG_EVR:
-                filterEvr(f, &m);
-                break;
-            case HY_PKG_NEVRA:
-                filterNevra(f, &m);
-                break;
-            case HY_PKG_VERSION:
-                filterVersion(f, &m);
-                break;
-            case HY_PKG_RELEASE:
-                filterRelease(f, &m);
-                break;
-            case HY_PKG_ARCH:
-                filterArch(f, &m);
-                break;
-            case HY_PKG_SOURCERPM:
-                filterSourcerpm(f, &m);
-                break;
-            case HY_PKG_OBSOLETES:
-                if (f.getMatchType() == _HY_RELDEP)
-                    filterRcoReldep(f, &m);
-                else {
-                    assert(f.getMatchType() == _HY_PKG);
-                    filterObsoletes(f, &m);
-                }
-                break;
-            case HY_PKG_OBSOLETES_BY_PRIORITY:
-                filterObsoletesByPriority(f, &m);
-                break;
-            case HY_PKG_PROVIDES:
-                assert(f.getMatchType() == _HY_RELDEP);
-                filterProvidesReldep(f, &m);
-                break;
-            case HY_PKG_CONFLICTS:
-            case HY_PKG_ENHANCES:
-            case HY_PKG_RECOMMENDS:
-            case HY_PKG_REQUIRES:
-            case HY_PKG_SUGGESTS:
-            case HY_PKG_SUPPLEMENTS:
-                if (f.getMatchType() == _HY_RELDEP)
-                    filterRcoReldep(f, &m);
-                else {
-                    filterDepSolvable(f, &m);
-                }
-                break;
-            case HY_PKG_REPONAME:
-                filterReponame(f, &m);
-                break;
-            case HY_PKG_LOCATION:
-                filterLocation(f, &m);
-                break;
-            case HY_PKG_ADVISORY:
-            case HY_PKG_ADVISORY_BUG:
-            case HY_PKG_ADVISORY_CVE:
-            case HY_PKG_ADVISORY_SEVERITY:
-            case HY_PKG_ADVISORY_TYPE:
-                filterAdvisory(f, &m, f.getKeyname());
-                break;
-            case HY_PKG_LATEST:
-            case HY_PKG_LATEST_PER_ARCH:
-            case HY_PKG_LATEST_PER_ARCH_BY_PRIORITY:
-                filterLatest(f, &m);
-                break;
-            case HY_PKG_DOWNGRADABLE:
-            case HY_PKG_UPGRADABLE:
-                filterUpdownAble(f, &m);
-                break;
-            case HY_PKG_DOWNGRADES:
-            case HY_PKG_UPGRADES:
-                filterUpdown(f, &m);
-                break;
-            case HY_PKG_UPGRADES_BY_PRIORITY:
-                filterUpdownByPriority(f, &m);
-                break;
-            default:
-                filterDataiterator(f, &m);
+        std::size_t inputSize = 0;
+        std::chrono::steady_clock::time_point start;
+        if (profiling) {
+            inputSize = result->size();
+            start = std::chrono::steady_clock::now();
         }
+        map_empty(&m);
+        applyFilter(f, &m);
         if (f.getCmpType() & HY_NOT)
             map_subtract(result->getMap(), &m);
         else
             map_and(result->getMap(), &m);
+        if (profiling) {
+            std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+            bool resultIndependent = filterDependency(f) == FilterDependency::NONE;
+            profile.push_back({f.getKeyname(), f.getCmpType(), inputSize, result->size(),
+                               time.count(), resultIndependent});
+        }
     }
     map_free(&m);
 
     applied = true;
     filters.clear();
+    if (cache)
+        cache->insert(std::move(signature), dnf_sack_get_generation(sack), *result);
+}
+
+void
+Query::Impl::applyFilter(const Filter & f, Map *m)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG:
+            filterPkg(f, m);
+            break;
+        case HY_PKG_ALL:
+        case HY_PKG_EMPTY:
+            /* used to set query empty by keeping Map m empty */
+            break;
+        case HY_PKG_NAME:
+            filterName(f, m);
+            break;
+        case HY_PKG_EPOCH:
+            filterEpoch(f, m);
+            break;
+        case HY_PKG_EVR:
+            filterEvr(f, m);
+            break;
+        case HY_PKG_NEVRA:
+            filterNevra(f, m);
+            break;
+        case HY_PKG_VERSION:
+            filterVersion(f, m);
+            break;
+        case HY_PKG_RELEASE:
+            filterRelease(f, m);
+            break;
+        case HY_PKG_ARCH:
+            filterArch(f, m);
+            break;
+        case HY_PKG_SOURCERPM:
+            filterSourcerpm(f, m);
+            break;
+        case HY_PKG_OBSOLETES:
+            if (f.getMatchType() == _HY_RELDEP)
+                filterRcoReldep(f, m);
+            else {
+                assert(f.getMatchType() == _HY_PKG);
+                filterObsoletes(f, m);
+            }
+            break;
+        case HY_PKG_OBSOLETES_BY_PRIORITY:
+            filterObsoletesByPriority(f, m);
+            break;
+        case HY_PKG_PROVIDES:
+            assert(f.getMatchType() == _HY_RELDEP);
+            filterProvidesReldep(f, m);
+            break;
+        case HY_PKG_CONFLICTS:
+        case HY_PKG_ENHANCES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+            if (f.getMatchType() == _HY_RELDEP)
+                filterRcoReldep(f, m);
+            else {
+                filterDepSolvable(f, m);
+            }
+            break;
+        case HY_PKG_REPONAME:
+            filterReponame(f, m);
+            break;
+        case HY_PKG_LOCATION:
+            filterLocation(f, m);
+            break;
+        case HY_PKG_ADVISORY:
+        case HY_PKG_ADVISORY_BUG:
+        case HY_PKG_ADVISORY_CVE:
+        case HY_PKG_ADVISORY_SEVERITY:
+        case HY_PKG_ADVISORY_TYPE:
+            filterAdvisory(f, m, f.getKeyname());
+            break;
+        case HY_PKG_LATEST:
+        case HY_PKG_LATEST_PER_ARCH:
+        case HY_PKG_LATEST_PER_ARCH_BY_PRIORITY:
+            filterLatest(f, m);
+            break;
+        case HY_PKG_DOWNGRADABLE:
+        case HY_PKG_UPGRADABLE:
+            filterUpdownAble(f, m);
+            break;
+        case HY_PKG_DOWNGRADES:
+        case HY_PKG_UPGRADES:
+            filterUpdown(f, m);
+            break;
+        case HY_PKG_UPGRADES_BY_PRIORITY:
+            filterUpdownByPriority(f, m);
+            break;
+        default:
+            filterDataiterator(f, m);
+    }
+}
+
+std::size_t
+Query::Impl::applyLazy(std::size_t limit, std::vector<Id> * out)
+{
+    // first block of candidates, every next block is twice as big
+    constexpr std::size_t LAZY_FIRST_BLOCK_SIZE = 64;
+
+    if (limit == 0)
+        return 0;
+
+    if (isCached())
+        apply();
+
+    // filters behind the last one which needs the whole result can be evaluated package by package
+    auto lazyBegin = filters.end();
+    while (lazyBegin != filters.begin() &&
+           filterDependency(*(lazyBegin - 1)) != FilterDependency::RESULT) {
+        --lazyBegin;
+    }
+    std::vector<Filter> lazyFilters(lazyBegin, filters.end());
+    filters.erase(lazyBegin, filters.end());
+    apply();
+
+    // all remaining filters are intersections, so their order does not matter. Those independent
+    // of the query result are cheap to apply at once.
+    Pool *pool = dnf_sack_get_pool(sack);
+    Map m;
+    map_init(&m, pool->nsolvables);
+    std::vector<Filter> packageFilters;
+    for (auto & f : lazyFilters) {
+        if (filterDependency(f) != FilterDependency::NONE) {
+            packageFilters.push_back(f);
+            continue;
+        }
+        map_empty(&m);
+        applyFilter(f, &m);
+        if (f.getCmpType() & HY_NOT)
+            map_subtract(result->getMap(), &m);
+        else
+            map_and(result->getMap(), &m);
+    }
+
+    std::size_t found = 0;
+    if (packageFilters.empty()) {
+        map_free(&m);
+        Id id = -1;
+        while (found < limit && (id = result->next(id)) != -1) {
+            if (out)
+                out->push_back(id);
+            ++found;
+        }
+        return found;
+    }
+
+    std::unique_ptr<PackageSet> candidates(std::move(result));
+    PackageSet matched(sack);
+    std::size_t blockSize = LAZY_FIRST_BLOCK_SIZE;
+    Id candidateId = candidates->next(-1);
+    while (candidateId != -1 && found < limit) {
+        // filter functions work on the result, use the block of candidates as the result
+        result.reset(new PackageSet(sack));
+        for (std::size_t i = 0; i < blockSize && candidateId != -1; ++i) {
+            result->set(candidateId);
+            candidateId = candidates->next(candidateId);
+        }
+        for (auto & f : packageFilters) {
+            if (result->empty())
+                break;
+            map_empty(&m);
+            applyFilter(f, &m);
+            if (f.getCmpType() & HY_NOT)
+                map_subtract(result->getMap(), &m);
+            else
+                map_and(result->getMap(), &m);
+        }
+        matched += *result;
+        Id id = -1;
+        while (found < limit && (id = result->next(id)) != -1) {
+            if (out)
+                out->push_back(id);
+            ++found;
+        }
+        blockSize *= 2;
+    }
+    map_free(&m);
+
+    if (candidateId == -1) {
+        // all candidates were evaluated, the result is complete
+        result.reset(new PackageSet(std::move(matched)));
+    } else {
+        result = std::move(candidates);
+        filters = std::move(packageFilters);
+        applied = false;
+    }
+    return found;
 }
 
 GPtrArray *
@@ -2466,8 +2834,16 @@ Query::queryDifference(Query & other)
 bool
 Query::empty()
 {
-    apply();
-    return pImpl->result->empty();
+    return pImpl->applyLazy(1, nullptr) == 0;
+}
+
+std::vector<Id>
+Query::getFirst(std::size_t limit)
+{
+    std::vector<Id> ids;
+    ids.reserve(limit);
+    pImpl->applyLazy(limit, &ids);
+    return ids;
 }
 
 void
@@ -2729,9 +3105,10 @@ Query::filterSubject(const char * subject, HyForm * forms, bool icase, bool with
 
     if (with_nevra) {
         Nevra nevraObj;
+        Nevra::Forms subjectForms(subject);
         const HyForm * tryForms = !forms ? HY_FORMS_MOST_SPEC : forms;
         for (std::size_t i = 0; tryForms[i] != _HY_FORM_STOP_; ++i) {
-            if (nevraObj.parse(subject, tryForms[i])) {
+            if (nevraObj.parse(subjectForms, tryForms[i])) {
                 addFilter(&nevraObj, icase);
                 if (!empty()) {
                     return {true, std::unique_ptr<Nevra>(new Nevra(std::move(nevraObj)))};
@@ -21,6 +21,7 @@
 #ifndef __QUERY_HPP
 #define __QUERY_HPP
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 #include "../hy-types.h"
@@ -65,6 +66,22 @@ private:
     std::shared_ptr<Impl> pImpl;
 };
 
+/**
+* @brief Statistics of one filter evaluated by Query::apply() with profiling enabled
+*/
+struct FilterProfile {
+    int keyname;
+    int cmpType;
+    /// Number of packages in the query before the filter was applied
+    std::size_t inputSize;
+    /// Number of packages in the query after the filter was applied
+    std::size_t outputSize;
+    /// Wall time in seconds
+    double time;
+    /// True if packages matched by the filter were computed without visiting the query packages
+    bool resultIndependent;
+};
+
 /**
 * @brief Provides package filtering
 * addFilter() can return DNF_ERROR_BAD_QUERY in case if cmp_type or keyname is incompatible with provided data type
@@ -125,6 +142,38 @@ public:
     int addFilter(HyNevra nevra, bool icase);
     void apply();
 
+    /**
+    * @brief Applies Query. When `profile` is true, statistics of the evaluated filters are recorded
+    * and can be obtained by getProfile().
+    *
+    * @param profile Enables recording of statistics
+    */
+    void apply(bool profile);
+
+    /**
+    * @brief Applies Query with profiling enabled and returns statistics of evaluated filters.
+    * Filters are not kept after the Query is applied, therefore it must not be applied yet.
+    * Throws libdnf::Error for an applied Query.
+    *
+    * @return const std::vector<FilterProfile>&
+    */
+    const std::vector<FilterProfile> & explain();
+
+    /**
+    * @brief Returns statistics of filters evaluated with profiling enabled
+    *
+    * @return const std::vector<FilterProfile>&
+    */
+    const std::vector<FilterProfile> & getProfile() const noexcept;
+
+    /**
+    * @brief Returns true when the result of the Query is available in the query cache of the sack
+    * (see dnf_sack_set_query_cache_size()) and apply() will not evaluate filters
+    *
+    * @return bool
+    */
+    bool isCached() const;
+
     /**
     * @brief Applies Query and returns DnfPackages in GPtrArray
     *
@@ -162,11 +211,22 @@ public:
     void queryDifference(Query & other);
 
     /**
-    * @brief Applies Query and returns true if any package in the query
+    * @brief Returns true if no package matches the query.
+    * Filters are evaluated lazily and the evaluation stops at the first matching package. The query
+    * is applied only when no package matches, otherwise its remaining filters are kept for apply().
     *
     * @return bool
     */
     bool empty();
+
+    /**
+    * @brief Returns Ids of at most `limit` first packages (in Id order) matching the query.
+    * Filters are evaluated lazily and the evaluation stops as soon as enough packages are found.
+    *
+    * @param limit Maximal number of returned packages
+    * @return std::vector<Id>
+    */
+    std::vector<Id> getFirst(std::size_t limit);
     /**
      * @brief Applies all filters and keep only installed packages that have no available package
      * with a same name and architecture.
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "updownindex.hpp"
+
+#include <unordered_map>
+
+extern "C" {
+#include <solv/evr.h>
+#include <solv/repo.h>
+}
+
+namespace libdnf {
+
+UpdownIndex::UpdownIndex(Pool * pool)
+: nsolvables(pool->nsolvables)
+{
+    Repo * installed = pool->installed;
+    if (!installed)
+        return;
+
+    // every binary package provides its own name, so looking up installed packages by name
+    // finds the same candidates as iterating the providers of the name
+    std::unordered_map<Id, std::vector<Solvable *>> installedByName;
+    Id p;
+    Solvable * s;
+    FOR_REPO_SOLVABLES(installed, p, s)
+        installedByName[s->name].push_back(s);
+    if (installedByName.empty())
+        return;
+
+    upgraded.assign(nsolvables, 0);
+    downgraded.assign(nsolvables, 0);
+    for (p = 2; p < nsolvables; ++p) {
+        s = pool_id2solvable(pool, p);
+        if (!s->repo || s->repo == installed)
+            continue;
+        auto it = installedByName.find(s->name);
+        if (it == installedByName.end())
+            continue;
+
+        // the same rules as what_upgrades()
+        Solvable * best = nullptr;
+        for (auto updated : it->second) {
+            if (updated->arch != s->arch && updated->arch != ARCH_NOARCH &&
+                s->arch != ARCH_NOARCH)
+                continue;
+            if (pool_evrcmp(pool, updated->evr, s->evr, EVRCMP_COMPARE) >= 0) {
+                best = nullptr;
+                break;
+            }
+            if (!best || pool_evrcmp(pool, updated->evr, best->evr, EVRCMP_COMPARE) > 0)
+                best = updated;
+        }
+        if (best)
+            upgraded[p] = pool_solvable2id(pool, best);
+
+        // the same rules as what_downgrades()
+        best = nullptr;
+        for (auto updated : it->second) {
+            if (updated->arch != s->arch)
+                continue;
+            if (pool_evrcmp(pool, updated->evr, s->evr, EVRCMP_COMPARE) <= 0) {
+                best = nullptr;
+                break;
+            }
+            if (!best || pool_evrcmp(pool, updated->evr, best->evr, EVRCMP_COMPARE) < 0)
+                best = updated;
+        }
+        if (best)
+            downgraded[p] = pool_solvable2id(pool, best);
+    }
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __UPDOWN_INDEX_HPP
+#define __UPDOWN_INDEX_HPP
+
+#include <vector>
+
+#include <solv/pool.h>
+
+namespace libdnf {
+
+/// Installed package upgraded or downgraded by each available package of a pool
+///
+/// The table is computed in a single pass over the pool and gives the same answers as
+/// what_upgrades() and what_downgrades() without scanning the providers of the name
+/// for every package. It is only valid as long as the pool is not modified.
+class UpdownIndex {
+public:
+    explicit UpdownIndex(Pool * pool);
+
+    /// Returns installed package that would be upgraded by package p or 0
+    Id upgrades(Id p) const { return p < static_cast<Id>(upgraded.size()) ? upgraded[p] : 0; }
+    /// Returns installed package that would be downgraded by package p or 0
+    Id downgrades(Id p) const { return p < static_cast<Id>(downgraded.size()) ? downgraded[p] : 0; }
+    /// Returns number of solvables of the pool at the time the index was built
+    int getNSolvables() const noexcept { return nsolvables; }
+
+private:
+    int nsolvables;
+    std::vector<Id> upgraded;
+    std::vector<Id> downgraded;
+};
+
+}
+
+#endif // __UPDOWN_INDEX_HPP
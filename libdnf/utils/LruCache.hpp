@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _LIBDNF_LRU_CACHE_HPP
+#define _LIBDNF_LRU_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace libdnf {
+
+/**
+* @brief Bounded LRU cache of values computed from the state of a sack
+*
+* Values are keyed by a signature of their inputs. Each value is valid only for the sack generation
+* it was stored with, the whole cache is dropped when a lookup or an insertion is done with a newer
+* generation.
+*/
+template<typename T>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity) : capacity(capacity) {}
+
+    /**
+    * @brief Returns cached value for the signature or nullptr. Found entry becomes the most
+    * recently used one.
+    */
+    const T * find(const std::string & signature, std::uint64_t generation);
+
+    /**
+    * @brief Stores value for the signature, the least recently used entry is evicted when the cache
+    * is full
+    */
+    void insert(std::string && signature, std::uint64_t generation, const T & value);
+
+    void clear() noexcept;
+    std::size_t size() const noexcept { return entries.size(); }
+    std::size_t getCapacity() const noexcept { return capacity; }
+    void setCapacity(std::size_t capacity);
+
+private:
+    struct Entry {
+        std::string signature;
+        T value;
+    };
+
+    void setGeneration(std::uint64_t generation);
+    void evictLast();
+
+    std::size_t capacity;
+    std::uint64_t generation{0};
+    /// most recently used entries first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+};
+
+template<typename T>
+const T *
+LruCache<T>::find(const std::string & signature, std::uint64_t generation)
+{
+    setGeneration(generation);
+    auto it = index.find(signature);
+    if (it == index.end())
+        return nullptr;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->value;
+}
+
+template<typename T>
+void
+LruCache<T>::insert(std::string && signature, std::uint64_t generation, const T & value)
+{
+    if (capacity == 0)
+        return;
+    setGeneration(generation);
+    auto it = index.find(signature);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    } else if (entries.size() >= capacity) {
+        evictLast();
+    }
+    entries.push_front({std::move(signature), value});
+    index.emplace(entries.front().signature, entries.begin());
+}
+
+template<typename T>
+void
+LruCache<T>::clear() noexcept
+{
+    index.clear();
+    entries.clear();
+}
+
+template<typename T>
+void
+LruCache<T>::setCapacity(std::size_t capacity)
+{
+    this->capacity = capacity;
+    while (entries.size() > capacity)
+        evictLast();
+}
+
+template<typename T>
+void
+LruCache<T>::setGeneration(std::uint64_t generation)
+{
+    if (this->generation == generation)
+        return;
+    clear();
+    this->generation = generation;
+}
+
+template<typename T>
+void
+LruCache<T>::evictLast()
+{
+    index.erase(entries.back().signature);
+    entries.pop_back();
+}
+
+}
+
+#endif // _LIBDNF_LRU_CACHE_HPP
@@ -402,6 +402,29 @@ exclude_from_weak_autodetect(_GoalObject *self, PyObject *unused) try
     Py_RETURN_NONE;
 } CATCH_TO_PYTHON
 
+static PyObject *
+get_stats(_GoalObject *self, PyObject *unused) try
+{
+    auto stats = self->goal->getStats();
+    UniquePtrPyObject rules(PyDict_New());
+    UniquePtrPyObject times(PyDict_New());
+    if (!rules || !times)
+        return NULL;
+    for (auto & rule : stats.rules) {
+        UniquePtrPyObject count(PyLong_FromLong(rule.second));
+        if (!count || PyDict_SetItemString(rules.get(), rule.first.c_str(), count.get()) == -1)
+            return NULL;
+    }
+    for (auto & phase : stats.phaseTimes) {
+        UniquePtrPyObject time(PyFloat_FromDouble(phase.second));
+        if (!time || PyDict_SetItemString(times.get(), phase.first.c_str(), time.get()) == -1)
+            return NULL;
+    }
+    return Py_BuildValue("{s:O,s:i,s:i,s:i,s:O}", "rules", rules.get(),
+                         "decisions", stats.decisions, "learnt_rules", stats.learntRules,
+                         "solve_passes", stats.solvePasses, "phase_times", times.get());
+} CATCH_TO_PYTHON
+
 static PyObject *
 run(_GoalObject *self, PyObject *args, PyObject *kwds) try
 {
@@ -415,6 +438,23 @@ run(_GoalObject *self, PyObject *args, PyObject *kwds) try
     Py_RETURN_FALSE;
 } CATCH_TO_PYTHON
 
+static PyObject *
+run_with_fallbacks(_GoalObject *self, PyObject *seq) try
+{
+    UniquePtrPyObject strategies(PySequence_Fast(seq, "Expected a sequence of flags."));
+    if (!strategies)
+        return NULL;
+    std::vector<DnfGoalActions> flags;
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(strategies.get());
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        long strategy = PyLong_AsLong(PySequence_Fast_GET_ITEM(strategies.get(), i));
+        if (strategy == -1 && PyErr_Occurred())
+            return NULL;
+        flags.push_back(static_cast<DnfGoalActions>(strategy));
+    }
+    return PyLong_FromLong(self->goal->runWithFallbacks(flags));
+} CATCH_TO_PYTHON
+
 static PyObject *
 count_problems(_GoalObject *self, PyObject *unused) try
 {
@@ -654,7 +694,9 @@ static struct PyMethodDef goal_methods[] = {
     {"req_length",        (PyCFunction)req_length,        METH_NOARGS,        NULL},
     {"run",                (PyCFunction)run,
      METH_VARARGS | METH_KEYWORDS, NULL},
+    {"run_with_fallbacks",        (PyCFunction)run_with_fallbacks,        METH_O,        NULL},
     {"count_problems",        (PyCFunction)count_problems,        METH_NOARGS,        NULL},
+    {"get_stats",        (PyCFunction)get_stats,        METH_NOARGS,        NULL},
     {"problem_conflicts",(PyCFunction)problem_conflicts,        METH_VARARGS | METH_KEYWORDS,                NULL},
     {"problem_broken_dependency",(PyCFunction)problem_broken_dependency,        METH_VARARGS | METH_KEYWORDS,                NULL},
     {"problem_rules", (PyCFunction)problem_rules,        METH_NOARGS,                NULL},
@@ -106,7 +106,7 @@ package_init(_PackageObject *self, PyObject *args, PyObject *kwds) try
         return -1;
     self->sack = sack;
     Py_INCREF(self->sack);
-    self->package = dnf_package_new(csack, id);
+    self->package = dnf_package_new_shared(csack, id);
     return 0;
 } CATCH_TO_PYTHON_INT
 
@@ -43,6 +43,7 @@
 #include "sack-py.hpp"
 #include "pycomp.hpp"
 #include "sack/advisorypkg.hpp"
+#include "sack/packagecolumns.hpp"
 #include "sack/packageset.hpp"
 #include "sack/selector.hpp"
 
@@ -662,6 +663,101 @@ apply(PyObject *self, PyObject *unused) try
     return self;
 } CATCH_TO_PYTHON
 
+static PyObject *
+explain(_QueryObject *self, PyObject *unused) try
+{
+    auto & profile = self->query->explain();
+    UniquePtrPyObject list(PyList_New(profile.size()));
+    if (!list)
+        return NULL;
+    for (std::size_t i = 0; i < profile.size(); ++i) {
+        auto & item = profile[i];
+        PyObject *dict = Py_BuildValue("{s:i,s:i,s:n,s:n,s:d,s:N}",
+            "keyname", item.keyname, "cmp_type", item.cmpType,
+            "input", static_cast<Py_ssize_t>(item.inputSize),
+            "output", static_cast<Py_ssize_t>(item.outputSize),
+            "time", item.time, "result_independent", PyBool_FromLong(item.resultIndependent));
+        if (!dict)
+            return NULL;
+        PyList_SET_ITEM(list.get(), i, dict);
+    }
+    return list.release();
+} CATCH_TO_PYTHON
+
+/* Copies a column into a buffer protocol object, typed by struct module format on Python 3 */
+static PyObject *
+column_to_buffer(const void *data, std::size_t size, const char *format)
+{
+    UniquePtrPyObject bytes(PyByteArray_FromStringAndSize(static_cast<const char *>(data), size));
+    if (!bytes)
+        return NULL;
+#if PY_MAJOR_VERSION >= 3
+    UniquePtrPyObject view(PyMemoryView_FromObject(bytes.get()));
+    if (!view)
+        return NULL;
+    return PyObject_CallMethod(view.get(), "cast", "s", format);
+#else
+    return bytes.release();
+#endif
+}
+
+static PyObject *
+columns(_QueryObject *self, PyObject *args) try
+{
+    PyObject *pyAttributes;
+    if (!PyArg_ParseTuple(args, "O", &pyAttributes))
+        return NULL;
+    std::vector<std::string> names;
+    try {
+        names = pySequenceConverter(pyAttributes);
+    } catch (std::runtime_error &) {
+        return NULL;
+    }
+    std::vector<libdnf::PackageColumns::Attribute> attributes(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (!libdnf::PackageColumns::attributeFromName(names[i].c_str(), attributes[i])) {
+            PyErr_Format(HyExc_Value, "Unknown package attribute: %s", names[i].c_str());
+            return NULL;
+        }
+    }
+
+    libdnf::PackageColumns table(*self->query->runSet(), attributes);
+    UniquePtrPyObject dict(PyDict_New());
+    if (!dict)
+        return NULL;
+
+    auto & ids = table.getIds();
+    UniquePtrPyObject buffer(column_to_buffer(ids.data(), ids.size() * sizeof(Id), "i"));
+    if (!buffer || PyDict_SetItemString(dict.get(), "ids", buffer.get()) == -1)
+        return NULL;
+
+    auto & strings = table.getStrings();
+    UniquePtrPyObject list(PyList_New(strings.size()));
+    if (!list)
+        return NULL;
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        PyObject *str = PyString_FromString(strings[i].c_str());
+        if (!str)
+            return NULL;
+        PyList_SET_ITEM(list.get(), i, str);
+    }
+    if (PyDict_SetItemString(dict.get(), "strings", list.get()) == -1)
+        return NULL;
+
+    for (std::size_t i = 0; i < attributes.size(); ++i) {
+        if (libdnf::PackageColumns::isNumeric(attributes[i])) {
+            auto & column = table.getNumericColumn(i);
+            buffer.reset(column_to_buffer(column.data(), column.size() * sizeof(column[0]), "Q"));
+        } else {
+            auto & column = table.getStringColumn(i);
+            buffer.reset(column_to_buffer(column.data(), column.size() * sizeof(column[0]), "I"));
+        }
+        if (!buffer || PyDict_SetItemString(dict.get(), names[i].c_str(), buffer.get()) == -1)
+            return NULL;
+    }
+    return dict.release();
+} CATCH_TO_PYTHON
+
 static PyObject *
 q_union(PyObject *self, PyObject *args) try
 {
@@ -1063,8 +1159,10 @@ static struct PyMethodDef query_methods[] = {
     {"apply", (PyCFunction)apply, METH_NOARGS,
      NULL},
     {"available", (PyCFunction)add_available_filter, METH_NOARGS, NULL},
+    {"columns", (PyCFunction)columns, METH_VARARGS, NULL},
     {"downgrades", (PyCFunction)add_downgrades_filter, METH_NOARGS, NULL},
     {"duplicated", (PyCFunction)duplicated_filter, METH_NOARGS, NULL},
+    {"explain", (PyCFunction)explain, METH_NOARGS, NULL},
     {"extras", (PyCFunction)add_filter_extras, METH_NOARGS, NULL},
     {"installed", (PyCFunction)add_installed_filter, METH_NOARGS, NULL},
     {"latest", (PyCFunction)add_filter_latest, METH_VARARGS, NULL},
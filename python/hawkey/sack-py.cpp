@@ -379,6 +379,38 @@ set_installonly_limit(_SackObject *self, PyObject *obj, void *unused) try
     return 0;
 } CATCH_TO_PYTHON_INT
 
+static PyObject *
+get_query_cache_size(_SackObject *self, void *unused) try
+{
+    return PyLong_FromUnsignedLong(dnf_sack_get_query_cache_size(self->sack));
+} CATCH_TO_PYTHON
+
+static int
+set_query_cache_size(_SackObject *self, PyObject *obj, void *unused) try
+{
+    unsigned long size = PyLong_AsUnsignedLong(obj);
+    if (PyErr_Occurred())
+        return -1;
+    dnf_sack_set_query_cache_size(self->sack, size);
+    return 0;
+} CATCH_TO_PYTHON_INT
+
+static PyObject *
+get_solve_cache_size(_SackObject *self, void *unused) try
+{
+    return PyLong_FromUnsignedLong(dnf_sack_get_solve_cache_size(self->sack));
+} CATCH_TO_PYTHON
+
+static int
+set_solve_cache_size(_SackObject *self, PyObject *obj, void *unused) try
+{
+    unsigned long size = PyLong_AsUnsignedLong(obj);
+    if (PyErr_Occurred())
+        return -1;
+    dnf_sack_set_solve_cache_size(self->sack, size);
+    return 0;
+} CATCH_TO_PYTHON_INT
+
 static int
 set_module_container(_SackObject *self, PyObject *obj, void *unused) try
 {
@@ -429,6 +461,10 @@ static PyGetSetDef sack_getsetters[] = {
     {(char*)"cache_dir",        (getter)get_cache_dir, NULL, NULL, NULL},
     {(char*)"installonly",        NULL, (setter)set_installonly, NULL, NULL},
     {(char*)"installonly_limit",        NULL, (setter)set_installonly_limit, NULL, NULL},
+    {(char*)"query_cache_size", (getter)get_query_cache_size, (setter)set_query_cache_size,
+        NULL, NULL},
+    {(char*)"solve_cache_size", (getter)get_solve_cache_size, (setter)set_solve_cache_size,
+        NULL, NULL},
     {(char*)"allow_vendor_change", NULL,
                                     (setter)set_allow_vendor_change, NULL, NULL},
     {(char*)"_moduleContainer",        (getter)get_module_container, (setter)set_module_container,
@@ -165,9 +165,10 @@ get_nevra_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
     if (!list)
         return NULL;
     libdnf::Nevra nevraObj;
+    libdnf::Nevra::Forms patternForms(self->pattern);
     if (forms && forms != Py_None) {
         if (PyInt_Check(forms)) {
-            if (nevraObj.parse(self->pattern, static_cast<HyForm>(PyLong_AsLong(forms)))) {
+            if (nevraObj.parse(patternForms, static_cast<HyForm>(PyLong_AsLong(forms)))) {
                 if (!addNevraToPyList(list.get(), std::move(nevraObj)))
                     return NULL;
             }
@@ -181,7 +182,7 @@ get_nevra_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
                     error = true;
                     break;
                 }
-                if (nevraObj.parse(self->pattern, static_cast<HyForm>(PyLong_AsLong(form)))) {
+                if (nevraObj.parse(patternForms, static_cast<HyForm>(PyLong_AsLong(form)))) {
                     if (!addNevraToPyList(list.get(), std::move(nevraObj)))
                         return NULL;
                 }
@@ -193,7 +194,7 @@ get_nevra_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     } else {
         for (std::size_t i = 0; HY_FORMS_MOST_SPEC[i] != _HY_FORM_STOP_; ++i) {
-            if (nevraObj.parse(self->pattern, HY_FORMS_MOST_SPEC[i])) {
+            if (nevraObj.parse(patternForms, HY_FORMS_MOST_SPEC[i])) {
                 if (!addNevraToPyList(list.get(), std::move(nevraObj)))
                     return NULL;
             }
@@ -230,9 +231,10 @@ nsvcap_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
     if (!list)
         return NULL;
     libdnf::Nsvcap nsvcapObj;
+    libdnf::Nsvcap::Forms patternForms(self->pattern);
     if (forms && forms != Py_None) {
         if (PyInt_Check(forms)) {
-            if (nsvcapObj.parse(self->pattern, static_cast<HyModuleForm>(PyLong_AsLong(forms)))) {
+            if (nsvcapObj.parse(patternForms, static_cast<HyModuleForm>(PyLong_AsLong(forms)))) {
                 if (!addNsvcapToPyList(list.get(), std::move(nsvcapObj)))
                     return NULL;
             }
@@ -246,7 +248,7 @@ nsvcap_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
                     error = true;
                     break;
                 }
-                if (nsvcapObj.parse(self->pattern, static_cast<HyModuleForm>(PyLong_AsLong(form)))) {
+                if (nsvcapObj.parse(patternForms, static_cast<HyModuleForm>(PyLong_AsLong(form)))) {
                     if (!addNsvcapToPyList(list.get(), std::move(nsvcapObj)))
                         return NULL;
                 }
@@ -258,7 +260,7 @@ nsvcap_possibilities(_SubjectObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     } else {
         for (std::size_t i = 0; HY_MODULE_FORMS_MOST_SPEC[i] != _HY_MODULE_FORM_STOP_; ++i) {
-            if (nsvcapObj.parse(self->pattern, HY_MODULE_FORMS_MOST_SPEC[i])) {
+            if (nsvcapObj.parse(patternForms, HY_MODULE_FORMS_MOST_SPEC[i])) {
                 if (!addNsvcapToPyList(list.get(), std::move(nsvcapObj)))
                     return NULL;
             }
@@ -54,10 +54,30 @@ class GoalTest(base.TestCase):
         goal3.add_protected(hawkey.Query(self.sack).filter(name="flying"))
         self.assertFalse(goal3.run(allow_uninstall=True))
 
+    def test_run_with_fallbacks(self):
+        pkg = base.by_name(self.sack, "penny-lib")
+        goal = hawkey.Goal(self.sack)
+        goal.erase(pkg)
+        self.assertEqual(goal.run_with_fallbacks([0, hawkey.ALLOW_UNINSTALL]), 1)
+        self.assertEqual(len(goal.list_erasures()), 2)
+        self.assertEqual(goal.run_with_fallbacks([0]), -1)
+        self.assertGreater(goal.count_problems(), 0)
+
     def test_list_err(self):
         goal = hawkey.Goal(self.sack)
         self.assertRaises(hawkey.ValueException, goal.list_installs)
 
+    def test_get_stats(self):
+        sltr = hawkey.Selector(self.sack).set(name="walrus")
+        goal = hawkey.Goal(self.sack)
+        goal.install(select=sltr)
+        self.assertTrue(goal.run())
+        stats = goal.get_stats()
+        self.assertGreaterEqual(stats['solve_passes'], 1)
+        self.assertGreater(stats['decisions'], 0)
+        self.assertIn('job', stats['phase_times'])
+        self.assertIn('pkg', stats['rules'])
+
     def test_empty_selector(self):
         sltr = hawkey.Selector(self.sack)
         goal = hawkey.Goal(self.sack)
@@ -53,6 +53,18 @@ class TestQuery(base.TestCase):
         q.filterm(name__eq=[u"flying", "penny"])
         self.assertEqual(q.count(), 2)
 
+    @unittest.skipIf(sys.version_info[0] < 3, "typed buffers need Python 3")
+    def test_columns(self):
+        q = hawkey.Query(self.sack).filter(name=["flying", "penny"])
+        table = q.columns(["name", "reponame", "buildtime"])
+        self.assertEqual(len(table["ids"]), 2)
+        self.assertEqual(len(table["buildtime"]), 2)
+        names = sorted(table["strings"][i] for i in table["name"])
+        self.assertEqual(names, ["flying", "penny"])
+        self.assertEqual(set(table["strings"][i] for i in table["reponame"]),
+                         set(pkg.reponame for pkg in q))
+        self.assertRaises(hawkey.ValueException, q.columns, ["flying"])
+
     def test_count(self):
         q = hawkey.Query(self.sack).filter(name=["flying", "penny"])
         self.assertEqual(len(q), 2)
@@ -220,6 +232,17 @@ class TestQuery(base.TestCase):
         self.assertItemsEqual(list(map(lambda p: p.name, res)),
                               ["baby", "bloop", "dog", "flying", "fool", "gun", "tour"])
 
+    def test_explain(self):
+        q = hawkey.Query(self.sack).filter(name__glob__not="p*").filter(name__glob__not="j*")
+        profile = q.explain()
+        self.assertLength(profile, 2)
+        self.assertEqual(profile[0]["keyname"], hawkey.PKG_NAME)
+        self.assertGreater(profile[0]["input"], profile[0]["output"])
+        self.assertEqual(profile[0]["output"], profile[1]["input"])
+        self.assertEqual(profile[1]["output"], len(q))
+        self.assertFalse(profile[1]["result_independent"])
+        self.assertRaises(hawkey.Exception, q.explain)
+
     def test_provides_glob_should_work(self):
         q1 = hawkey.Query(self.sack).filter(provides__glob="penny*")
         self.assertLength(q1, 2)
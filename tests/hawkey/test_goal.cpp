@@ -177,6 +177,43 @@ START_TEST(test_goal_install)
 }
 END_TEST
 
+START_TEST(test_goal_solve_cache)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_set_solve_cache_size(sack, 2);
+    DnfPackage *pkg = get_latest_pkg(sack, "walrus");
+
+    HyGoal goal = hy_goal_create(sack);
+    fail_if(hy_goal_install(goal, pkg));
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    // the second goal takes the solution of the first one
+    HyGoal goal2 = hy_goal_create(sack);
+    fail_if(hy_goal_install(goal2, pkg));
+    fail_if(hy_goal_run_flags(goal2, DNF_NONE));
+    ck_assert_int_eq(goal2->getStats().solvePasses, 0);
+    hy_goal_free(goal);
+    assert_iueo(goal2, 2, 0, 0, 0);
+    // a goal using a shared solution can be resolved again
+    fail_if(hy_goal_run_flags(goal2, DNF_IGNORE_WEAK_DEPS));
+    fail_unless(goal2->getStats().solvePasses > 0);
+    assert_iueo(goal2, 2, 0, 0, 0);
+    hy_goal_free(goal2);
+
+    // changed installonly names are not served from the cache
+    HyGoal goal3 = hy_goal_create(sack);
+    fail_if(hy_goal_install(goal3, pkg));
+    const char *installonly[] = {"walrus", NULL};
+    dnf_sack_set_installonly(sack, installonly);
+    fail_if(hy_goal_run_flags(goal3, DNF_NONE));
+    fail_unless(goal3->getStats().solvePasses > 0);
+    dnf_sack_set_installonly(sack, NULL);
+    hy_goal_free(goal3);
+
+    g_object_unref(pkg);
+    dnf_sack_set_solve_cache_size(sack, 0);
+}
+END_TEST
+
 START_TEST(test_goal_install_multilib)
 {
     // Tests installation of multilib package. The package is selected via
@@ -640,6 +677,10 @@ START_TEST(test_goal_erase_with_deps)
     HyGoal goal = hy_goal_create(sack);
     hy_goal_erase(goal, pkg);
     fail_unless(hy_goal_run_flags(goal, DNF_NONE));
+    // no protected packages are set, the problem comes from libsolv
+    auto problems = goal->describeProblemRules(0, true);
+    fail_if(problems.empty());
+    fail_unless(problems[0].find("protected") == std::string::npos);
     hy_goal_free(goal);
 
     goal = hy_goal_create(sack);
@@ -746,6 +787,24 @@ START_TEST(test_goal_forcebest)
 }
 END_TEST
 
+START_TEST(test_goal_run_with_fallbacks)
+{
+    DnfSack *sack = test_globals.sack;
+    HyGoal goal = hy_goal_create(sack);
+    HySelector sltr = hy_selector_create(sack);
+
+    hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, "flying");
+    hy_goal_upgrade_selector(goal, sltr);
+    ck_assert_int_eq(goal->runWithFallbacks({DNF_FORCE_BEST, DNF_NONE}), 1);
+    ck_assert_int_eq(hy_goal_count_problems(goal), 0);
+    ck_assert_int_eq(goal->runWithFallbacks({DNF_FORCE_BEST}), -1);
+    ck_assert_int_eq(hy_goal_count_problems(goal), 1);
+
+    hy_selector_free(sltr);
+    hy_goal_free(goal);
+}
+END_TEST
+
 START_TEST(test_goal_favor)
 {
     DnfSack *sack = test_globals.sack;
@@ -945,6 +1004,29 @@ START_TEST(test_goal_upgrade_all_excludes)
 }
 END_TEST
 
+START_TEST(test_goal_rerun_excludes)
+{
+    DnfSack *sack = test_globals.sack;
+    HyGoal goal = hy_goal_create(sack);
+    hy_goal_upgrade_all(goal);
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+
+    HyQuery q = hy_query_create_flags(sack, HY_IGNORE_EXCLUDES);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "pilchard");
+    DnfPackageSet *pset = hy_query_run_set(q);
+    dnf_sack_add_excludes(sack, pset);
+    dnf_packageset_free(pset);
+    hy_query_free(q);
+
+    // rules of the previous run must not allow the excluded packages
+    fail_if(hy_goal_run_flags(goal, DNF_NONE));
+    GPtrArray *plist = hy_goal_list_upgrades(goal, NULL);
+    assert_list_names<&dnf_package_get_name>(true, plist, "bloop", "dog", "flying", "fool", NULL);
+    g_ptr_array_unref(plist);
+    hy_goal_free(goal);
+}
+END_TEST
+
 START_TEST(test_goal_upgrade_disabled_repo)
 {
     DnfSack *sack = test_globals.sack;
@@ -1395,6 +1477,7 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_sanity);
     tcase_add_test(tc, test_goal_list_err);
     tcase_add_test(tc, test_goal_install);
+    tcase_add_test(tc, test_goal_solve_cache);
     tcase_add_test(tc, test_goal_install_multilib);
     tcase_add_test(tc, test_goal_install_selector);
     tcase_add_test(tc, test_goal_install_selector_err);
@@ -1417,6 +1500,7 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_protected);
     tcase_add_test(tc, test_goal_erase_clean_deps);
     tcase_add_test(tc, test_goal_forcebest);
+    tcase_add_test(tc, test_goal_run_with_fallbacks);
     tcase_add_test(tc, test_goal_favor);
     tcase_add_test(tc, test_goal_disfavor);
     tcase_add_test(tc, test_goal_lock);
@@ -1428,6 +1512,7 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_installonly);
     tcase_add_test(tc, test_goal_installonly_upgrade_all);
     tcase_add_test(tc, test_goal_upgrade_all_excludes);
+    tcase_add_test(tc, test_goal_rerun_excludes);
     tcase_add_test(tc, test_goal_upgrade_disabled_repo);
     tcase_add_test(tc, test_goal_describe_problem_excludes);
     suite_add_tcase(s, tc);
@@ -61,6 +61,56 @@ START_TEST(test_identical)
 }
 END_TEST
 
+START_TEST(test_shared)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg = by_name(sack, "penny-lib");
+    Id id = dnf_package_get_id(pkg);
+
+    DnfPackage *shared1 = dnf_package_new_shared(sack, id);
+    DnfPackage *shared2 = dnf_package_new_shared(sack, id);
+    fail_unless(shared1 == shared2);
+    fail_if(shared1 == pkg);
+    fail_unless(dnf_package_get_identical(shared1, pkg));
+    // mark the instance, the address alone may be reused by the next allocation
+    g_object_set_data(G_OBJECT(shared1), "test-shared-marker", GINT_TO_POINTER(1));
+    gpointer released = shared1;
+    g_object_add_weak_pointer(G_OBJECT(shared1), &released);
+    g_object_unref(shared1);
+    g_object_unref(shared2);
+    fail_unless(released == NULL);
+
+    // the slot of the finalized instance is cleared, a new instance is created
+    shared1 = dnf_package_new_shared(sack, id);
+    fail_unless(dnf_package_get_id(shared1) == id);
+    fail_unless(g_object_get_data(G_OBJECT(shared1), "test-shared-marker") == NULL);
+    shared2 = dnf_package_new_shared(sack, id);
+    fail_unless(shared1 == shared2);
+    g_object_unref(shared2);
+    g_object_unref(shared1);
+    g_object_unref(pkg);
+}
+END_TEST
+
+START_TEST(test_shared_out_of_range)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    const Id ids[] = {-1, 0, pool->nsolvables, G_MAXINT32};
+
+    // ids that are not solvables of the pool are not shared and do not grow the table
+    for (Id id : ids) {
+        DnfPackage *pkg1 = dnf_package_new_shared(sack, id);
+        DnfPackage *pkg2 = dnf_package_new_shared(sack, id);
+        fail_unless(dnf_package_get_id(pkg1) == id);
+        fail_if(pkg1 == pkg2);
+        g_object_unref(pkg1);
+        g_object_unref(pkg2);
+    }
+    fail_unless(dnf_sack_get_shared_packages(sack).size() <= static_cast<size_t>(pool->nsolvables));
+}
+END_TEST
+
 START_TEST(test_versions)
 {
     DnfSack *sack = test_globals.sack;
@@ -361,6 +411,8 @@ package_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_system_only, teardown);
     tcase_add_test(tc, test_package_summary);
     tcase_add_test(tc, test_identical);
+    tcase_add_test(tc, test_shared);
+    tcase_add_test(tc, test_shared_out_of_range);
     tcase_add_test(tc, test_versions);
     tcase_add_test(tc, test_no_sourcerpm);
     suite_add_tcase(s, tc);
@@ -25,6 +25,8 @@
 #include "libdnf/dnf-reldep.h"
 #include "libdnf/dnf-reldep-list.h"
 #include "libdnf/dnf-sack-private.hpp"
+#include "libdnf/error.hpp"
+#include "libdnf/hy-iutil-private.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
 #include "libdnf/sack/packageset.hpp"
 #include "libdnf/sack/query.hpp"
@@ -814,6 +816,100 @@ START_TEST(test_filter_reponames)
 }
 END_TEST
 
+static Id
+get_pkg_id(DnfSack *sack, const char *nevra, const char *reponame)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NEVRA_STRICT, HY_EQ, nevra);
+    hy_query_filter(q, HY_PKG_REPONAME, HY_EQ, reponame);
+    auto pset = q->runSet();
+    ck_assert_int_eq(pset->size(), 1);
+    Id id = (*pset)[0];
+    hy_query_free(q);
+    return id;
+}
+
+START_TEST(test_updown_index)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    dnf_sack_make_provides_ready(sack);
+    auto & updown = dnf_sack_get_updown_index(sack);
+
+    // the index answers the same as scanning providers of the name of each package
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (!s->repo || s->repo == pool->installed)
+            continue;
+        ck_assert_int_eq(updown.upgrades(p), what_upgrades(pool, p));
+        ck_assert_int_eq(updown.downgrades(p), what_downgrades(pool, p));
+    }
+
+    // an arch package upgrades a noarch one
+    Id installed = get_pkg_id(sack, "flying-2-9.noarch", HY_SYSTEM_REPO_NAME);
+    ck_assert_int_eq(updown.upgrades(get_pkg_id(sack, "flying-3.1-0.x86_64", "updates")), installed);
+    // but not a package of another arch
+    ck_assert_int_eq(updown.upgrades(get_pkg_id(sack, "dog-1-2.i686", "updates")), 0);
+    installed = get_pkg_id(sack, "dog-1-1.x86_64", HY_SYSTEM_REPO_NAME);
+    ck_assert_int_eq(updown.upgrades(get_pkg_id(sack, "dog-1-2.x86_64", "updates")), installed);
+
+    // a newer installed version prevents the upgrade, the lowest version is downgraded
+    Id available = get_pkg_id(sack, "jay-5.0-0.x86_64", "main");
+    ck_assert_int_eq(updown.upgrades(available), 0);
+    ck_assert_int_eq(updown.downgrades(available), 0);
+    installed = get_pkg_id(sack, "jay-5.0-0.x86_64", HY_SYSTEM_REPO_NAME);
+    ck_assert_int_eq(updown.downgrades(get_pkg_id(sack, "jay-4.9-0.x86_64", "main")), installed);
+}
+END_TEST
+
+START_TEST(test_updown_noarch_arch)
+{
+    DnfSack *sack = test_globals.sack;
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "flying");
+    hy_query_filter_upgrades(q, 1);
+    ck_assert_int_eq(query_count_results(q), 4);
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    ck_assert_int_eq(query_count_results(q), 1);
+    hy_query_free(q);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "flying");
+    hy_query_filter_num(q, HY_PKG_UPGRADES_BY_PRIORITY, HY_EQ, 1);
+    ck_assert_int_eq(query_count_results(q), 4);
+    hy_query_free(q);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "flying");
+    hy_query_filter_upgradable(q, 1);
+    ck_assert_int_eq(query_count_results(q), 1);
+    hy_query_free(q);
+
+    // only the package of the same arch upgrades dog
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "dog");
+    hy_query_filter_upgrades(q, 1);
+    GPtrArray *plist = hy_query_run(q);
+    fail_unless(plist->len == 1);
+    auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, 0));
+    ck_assert_str_eq(dnf_package_get_arch(pkg), "x86_64");
+    g_ptr_array_unref(plist);
+    hy_query_free(q);
+
+    // installed jay-6.0 is not downgradable to jay-5.0 which is installed too
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter_downgradable(q, 1);
+    plist = hy_query_run(q);
+    fail_unless(plist->len == 1);
+    pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, 0));
+    ck_assert_str_eq(dnf_package_get_evr(pkg), "5.0-0");
+    g_ptr_array_unref(plist);
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_excluded)
 {
     DnfSack *sack = test_globals.sack;
@@ -837,6 +933,38 @@ START_TEST(test_excluded)
 }
 END_TEST
 
+START_TEST(test_query_cache)
+{
+    DnfSack *sack = test_globals.sack;
+    dnf_sack_set_query_cache_size(sack, 4);
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    int count = query_count_results(q);
+    fail_unless(count > 0);
+    DnfPackageSet *pset = hy_query_run_set(q);
+    hy_query_free(q);
+
+    // the same query is answered from the cache
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    fail_unless(q->isCached());
+    ck_assert_int_eq(query_count_results(q), count);
+    hy_query_free(q);
+
+    // excludes change the sack generation
+    dnf_sack_add_excludes(sack, pset);
+    delete pset;
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    fail_if(q->isCached());
+    ck_assert_int_eq(query_count_results(q), 0);
+    hy_query_free(q);
+
+    dnf_sack_set_query_cache_size(sack, 0);
+}
+END_TEST
+
 START_TEST(test_disabled_repo)
 {
     DnfSack *sack = test_globals.sack;
@@ -944,6 +1072,67 @@ START_TEST(test_query_apply)
 }
 END_TEST
 
+START_TEST(test_query_lazy)
+{
+    DnfSack *sack = test_globals.sack;
+    HyQuery q;
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_NOT | HY_GLOB, "j*");
+    hy_query_filter(q, HY_PKG_NAME, HY_NOT | HY_GLOB, "p*");
+    fail_if(q->empty());
+    auto first = q->getFirst(2);
+    ck_assert_int_eq(first.size(), 2);
+    ck_assert_int_eq(q->size(), 7);
+    ck_assert_int_eq(first[0], q->getIndexItem(0));
+    ck_assert_int_eq(first[1], q->getIndexItem(1));
+    ck_assert_int_eq(q->getFirst(10).size(), 7);
+    hy_query_free(q);
+
+    // when nothing matches, all candidates were evaluated and the query is applied
+    q = hy_query_create(sack);
+    hy_query_filter_latest_per_arch(q, 1);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "no-such-package");
+    fail_unless(q->empty());
+    ck_assert_int_eq(q->getApplied(), 1);
+    ck_assert_int_eq(q->getFirst(1).size(), 0);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_query_explain)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_NOT | HY_GLOB, "j*");
+    hy_query_filter(q, HY_PKG_NAME, HY_NOT | HY_GLOB, "p*");
+    auto & profile = q->explain();
+    ck_assert_int_eq(profile.size(), 2);
+    ck_assert_int_eq(profile[0].keyname, HY_PKG_NAME);
+    ck_assert_int_eq(profile[0].cmpType, HY_NOT | HY_GLOB);
+    fail_unless(profile[0].inputSize > profile[0].outputSize);
+    ck_assert_int_eq(profile[0].outputSize, profile[1].inputSize);
+    ck_assert_int_eq(profile[1].outputSize, q->size());
+    fail_if(profile[1].resultIndependent);
+    // filters of an applied query are gone
+    bool thrown = false;
+    try {
+        q->explain();
+    } catch (const libdnf::Error &) {
+        thrown = true;
+    }
+    fail_unless(thrown);
+    hy_query_free(q);
+
+    // profile of a filter matched without visiting the query packages
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter_provides(q, HY_EQ, "penny-lib", NULL);
+    auto & providesProfile = q->explain();
+    ck_assert_int_eq(providesProfile.size(), 1);
+    fail_unless(providesProfile[0].resultIndependent);
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_filter_advisory)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -1064,6 +1253,8 @@ query_suite(void)
     tcase_add_test(tc, test_query_nevra_glob);
     tcase_add_test(tc, test_query_multiple_flags);
     tcase_add_test(tc, test_query_apply);
+    tcase_add_test(tc, test_query_lazy);
+    tcase_add_test(tc, test_query_explain);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Updates");
@@ -1099,6 +1290,8 @@ query_suite(void)
     tcase_add_test(tc, test_filter_latest_archs);
     tcase_add_test(tc, test_filter_obsoletes);
     tcase_add_test(tc, test_filter_reponames);
+    tcase_add_test(tc, test_updown_index);
+    tcase_add_test(tc, test_updown_noarch_arch);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Filelists etc.");
@@ -1113,6 +1306,7 @@ query_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_with_main, teardown);
     tcase_add_checked_fixture(tc, fixture_reset, NULL);
     tcase_add_test(tc, test_excluded);
+    tcase_add_test(tc, test_query_cache);
     tcase_add_test(tc, test_disabled_repo);
     suite_add_tcase(s, tc);
 
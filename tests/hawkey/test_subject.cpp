@@ -153,6 +153,65 @@ START_TEST(na)
 }
 END_TEST
 
+START_TEST(nevra_forms)
+{
+    libdnf::Nevra::Forms forms(inp_fof);
+    auto nevra = forms.find(HY_FORM_NEVRA);
+    fail_unless(nevra != nullptr);
+    ck_assert_str_eq(nevra->name.toString().c_str(), "four-of-fish");
+    ck_assert_int_eq(nevra->epoch, 8);
+    ck_assert_str_eq(nevra->version.toString().c_str(), "3.6.9");
+    ck_assert_str_eq(nevra->release.toString().c_str(), "11.fc100");
+    ck_assert_str_eq(nevra->arch.toString().c_str(), "x86_64");
+
+    auto nevr = forms.find(HY_FORM_NEVR);
+    fail_unless(nevr != nullptr);
+    ck_assert_str_eq(nevr->release.toString().c_str(), "11.fc100.x86_64");
+    fail_unless(nevr->arch.empty());
+
+    // the colon cannot be a part of the name
+    fail_unless(forms.find(HY_FORM_NEV) == nullptr);
+    fail_unless(forms.find(HY_FORM_NA) == nullptr);
+    fail_unless(forms.find(HY_FORM_NAME) == nullptr);
+    fail_unless(forms.find(_HY_FORM_STOP_) == nullptr);
+
+    libdnf::Nevra::Forms naForms(inp_fof_na);
+    auto na = naForms.find(HY_FORM_NA);
+    fail_unless(na != nullptr);
+    ck_assert_str_eq(na->name.toString().c_str(), "four-of-fish-3.6.9");
+    ck_assert_str_eq(na->arch.toString().c_str(), "i686");
+    fail_unless(naForms.find(HY_FORM_NAME) != nullptr);
+
+    libdnf::Nevra::Forms invalidForms("four-of-fish>=3.6.9");
+    for (int form = HY_FORM_NEVRA; form <= HY_FORM_NAME; ++form)
+        fail_unless(invalidForms.find(static_cast<HyForm>(form)) == nullptr);
+}
+END_TEST
+
+START_TEST(module_forms)
+{
+    libdnf::Nsvcap::Forms forms(module_nsvca);
+    ck_assert_int_eq(forms.getForm(), HY_MODULE_FORM_NSVCA);
+    fail_unless(forms.find(HY_MODULE_FORM_NSVCAP) == nullptr);
+    auto nsvca = forms.find(HY_MODULE_FORM_NSVCA);
+    fail_unless(nsvca != nullptr);
+    ck_assert_str_eq(nsvca->name.toString().c_str(), "module-name");
+    ck_assert_str_eq(nsvca->context.toString().c_str(), "b86c854");
+    ck_assert_str_eq(nsvca->arch.toString().c_str(), "x86_64");
+    fail_unless(nsvca->profile.empty());
+
+    libdnf::Nsvcap::Forms doubleColonForms("module-name:stream:1:b86c854::x86_64/");
+    ck_assert_int_eq(doubleColonForms.getForm(), HY_MODULE_FORM_NSVCA);
+
+    libdnf::Nsvcap::Forms invalidVersion("module-name:stream:1.0");
+    ck_assert_int_eq(invalidVersion.getForm(), _HY_MODULE_FORM_STOP_);
+
+    libdnf::Nsvcap nsvcap;
+    ck_assert(!nsvcap.parse("module-name:stream/profile/other", HY_MODULE_FORM_NSP));
+    ck_assert(!nsvcap.parse("module-name:::x86_64", HY_MODULE_FORM_NSA));
+}
+END_TEST
+
 START_TEST(module_form_nsvcap)
 {
     libdnf::Nsvcap nsvcap;
@@ -331,6 +390,7 @@ subject_suite(void)
     tcase_add_test(tc, nevr_fail);
     tcase_add_test(tc, nev);
     tcase_add_test(tc, na);
+    tcase_add_test(tc, nevra_forms);
     tcase_add_test(tc, module_form_nsvcap);
     tcase_add_test(tc, module_form_nsvap);
     tcase_add_test(tc, module_form_nsvca);
@@ -347,6 +407,7 @@ subject_suite(void)
     tcase_add_test(tc, module_form_na);
     tcase_add_test(tc, module_form_np);
     tcase_add_test(tc, module_form_n);
+    tcase_add_test(tc, module_forms);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Full");
@@ -4,6 +4,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ContextTest);
 
 #include "libdnf/dnf-context.hpp"
 #include "libdnf/dnf-repo-loader.h"
+#include "libdnf/hy-repo.h"
 #include "libdnf/sack/query.hpp"
 #include "libdnf/nevra.hpp"
 #include "libdnf/utils/File.hpp"
@@ -35,7 +36,7 @@ static gboolean pkglist_has_nevra(GPtrArray *pkglist, const char *nevra)
     return FALSE;
 }
 
-void ContextTest::testLoadModules()
+DnfSack * ContextTest::setupModularSack()
 {
     GError *error = nullptr;
 
@@ -72,7 +73,14 @@ void ContextTest::testLoadModules()
     dnf_context_setup_sack(context, state, &error);
     g_assert_no_error(error);
 
-    auto sack = dnf_context_get_sack(context);
+    return dnf_context_get_sack(context);
+}
+
+void ContextTest::testLoadModules()
+{
+    GError *error = nullptr;
+    auto sack = setupModularSack();
+
     auto moduleExcludes = std::unique_ptr<libdnf::PackageSet>(dnf_sack_get_module_excludes(sack));
     CPPUNIT_ASSERT(moduleExcludes->size() != 0);
 
@@ -187,6 +195,36 @@ void ContextTest::testLoadModules()
     g_assert_no_error(error);
 }
 
+void ContextTest::testModuleExcludesAfterNewRepo()
+{
+    GError *error = nullptr;
+    auto sack = setupModularSack();
+    auto moduleContainer = dnf_sack_get_module_container(sack);
+    const char * hotfixRepos[] = {nullptr};
+
+    // packages matched by modules are cached by the container, a repo loaded later adds a package
+    // with the name of an artifact of the default httpd:2.4 stream and a package providing it
+    constexpr auto repodata = TESTDATADIR "/modules/modules/_non-modular/x86_64/repodata/";
+    HyRepo repo = hy_repo_create("non-modular");
+    hy_repo_set_string(repo, HY_REPO_MD_FN, (std::string(repodata) + "repomd.xml").c_str());
+    hy_repo_set_string(repo, HY_REPO_PRIMARY_FN, (std::string(repodata) +
+        "76753a7f9105e5ed8337991367a498ba6843ebe3f0778b9708aab2c4188f87d2-primary.xml.gz").c_str());
+    CPPUNIT_ASSERT(dnf_sack_load_repo(sack, repo, 0, &error));
+    g_assert_no_error(error);
+    hy_repo_free(repo);
+
+    dnf_sack_filter_modules_v2(sack, moduleContainer, hotfixRepos, nullptr, nullptr, true, false, false);
+    auto moduleExcludes = std::unique_ptr<libdnf::PackageSet>(dnf_sack_get_module_excludes(sack));
+    const char * repos[] = {"non-modular", nullptr};
+    for (auto nevra : {"httpd-2.2.10-1.x86_64", "httpd-provides-name-3.0-1.x86_64"}) {
+        libdnf::Query query(sack, libdnf::Query::ExcludeFlags::IGNORE_EXCLUDES);
+        query.addFilter(HY_PKG_REPONAME, HY_EQ, repos);
+        query.addFilter(HY_PKG_NEVRA_STRICT, HY_EQ, nevra);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), query.size());
+        CPPUNIT_ASSERT(moduleExcludes->has((*query.runSet())[0]));
+    }
+}
+
 void ContextTest::sackHas(DnfSack * sack, libdnf::ModulePackage * pkg) const
 {
     libdnf::Query query{sack};
@@ -10,6 +10,7 @@ class ContextTest : public CppUnit::TestCase
 {
     CPPUNIT_TEST_SUITE(ContextTest);
         CPPUNIT_TEST(testLoadModules);
+        CPPUNIT_TEST(testModuleExcludesAfterNewRepo);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -17,9 +18,11 @@ public:
     void tearDown() override;
 
     void testLoadModules();
+    void testModuleExcludesAfterNewRepo();
 
 private:
     DnfContext *context;
+    DnfSack * setupModularSack();
     void sackHas(DnfSack * sack, libdnf::ModulePackage * pkg) const;
     void sackHasNot(DnfSack * sack, libdnf::ModulePackage * pkg) const;
 };
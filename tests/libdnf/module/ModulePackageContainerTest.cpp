@@ -5,8 +5,12 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ModulePackageContainerTest);
 #include "libdnf/log.hpp"
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/hy-iutil-private.hpp"
+#include "libdnf/hy-repo.h"
+#include "libdnf/utils/File.hpp"
 
 #include <algorithm>
+#include <cstring>
+#include <map>
 
 #define UNITTEST_DIR "/tmp/libdnf22XXXXXX"
 
@@ -156,3 +160,114 @@ void ModulePackageContainerTest::testInstallRemoveProfile()
 
     modules->save();
 }
+
+void ModulePackageContainerTest::testAddConcurrently()
+{
+    // more repositories than threads parsing their metadata
+    const unsigned int nThreads = 3;
+    const unsigned int nRepos = 7;
+    const unsigned int firstMissing = 1;
+    const unsigned int secondMissing = nRepos - 1;
+
+    auto loadSack = [&](bool withMissing) {
+        GError *error = nullptr;
+        DnfSack *sack = dnf_sack_new();
+        dnf_sack_set_cachedir(sack, tmpdir);
+        CPPUNIT_ASSERT(dnf_sack_set_arch(sack, "x86_64", &error));
+        g_assert_no_error(error);
+        for (unsigned int i = 0; i < nRepos; ++i) {
+            auto name = "repo" + std::to_string(i);
+            auto modulesFn = std::string(TESTDATADIR "/modules/modules/_all/x86_64/repodata/"
+                "02517771d46f54572e172605d193e70f158fc88db676cd7d02158736a8f8c7f8-modules.yaml.gz");
+            if (withMissing && i == firstMissing) {
+                modulesFn = std::string(tmpdir) + "/first-missing-modules.yaml";
+            } else if (withMissing && i == secondMissing) {
+                modulesFn = std::string(tmpdir) + "/second-missing-modules.yaml";
+            }
+            HyRepo repo = hy_repo_create(name.c_str());
+            hy_repo_set_string(repo, HY_REPO_MD_FN,
+                TESTDATADIR "/modules/modules/_all/x86_64/repodata/repomd.xml");
+            hy_repo_set_string(repo, HY_REPO_PRIMARY_FN,
+                TESTDATADIR "/modules/modules/_all/x86_64/repodata/"
+                "7b20d2285e9d41d2f96f67029a28d11249485ad787606017bd855a3263d2209b-primary.xml.gz");
+            hy_repo_set_string(repo, MODULES_FN, modulesFn.c_str());
+            CPPUNIT_ASSERT(dnf_sack_load_repo(sack, repo, 0, &error));
+            g_assert_no_error(error);
+            hy_repo_free(repo);
+        }
+        return sack;
+    };
+
+    {
+        g_autoptr(DnfSack) sack = loadSack(false);
+        libdnf::ModulePackageContainer container(true, tmpdir, "x86_64");
+        container.add(sack, nThreads);
+
+        // every repository contributes the same modules
+        std::map<std::string, std::size_t> perRepo;
+        for (auto modulePackage : container.getModulePackages()) {
+            ++perRepo[modulePackage->getRepoID()];
+        }
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(nRepos), perRepo.size());
+        auto nModules = perRepo.begin()->second;
+        CPPUNIT_ASSERT(nModules > 0);
+        for (auto & repoModules : perRepo) {
+            CPPUNIT_ASSERT_EQUAL(nModules, repoModules.second);
+        }
+    }
+
+    {
+        // the failure of the first repository in the order of the sack is reported, whichever
+        // thread finishes first
+        g_autoptr(DnfSack) sack = loadSack(true);
+        libdnf::ModulePackageContainer container(true, tmpdir, "x86_64");
+        try {
+            container.add(sack, nThreads);
+            CPPUNIT_FAIL("missing modules metadata must be reported");
+        } catch (const libdnf::File::OpenError & e) {
+            CPPUNIT_ASSERT(std::strstr(e.what(), "first-missing-modules.yaml"));
+        }
+    }
+}
+
+static std::string moduleYaml(const char * stream, const char * context)
+{
+    return std::string("---\n"
+        "document: modulemd\n"
+        "version: 2\n"
+        "data:\n"
+        "  name: conflicting\n"
+        "  stream: ") + stream + "\n"
+        "  version: 1\n"
+        "  context: " + context + "\n"
+        "  arch: x86_64\n"
+        "  summary: Fake module\n"
+        "  description: >-\n"
+        "    Fake module\n"
+        "  license:\n"
+        "    module:\n"
+        "    - MIT\n"
+        "...\n";
+}
+
+void ModulePackageContainerTest::testConflictsBetweenStreams()
+{
+    // stream 1 is built in two contexts, they must not conflict with each other
+    libdnf::ModulePackageContainer container(true, tmpdir, "x86_64");
+    container.add(moduleYaml("1", "aaaaaaaa") + moduleYaml("1", "bbbbbbbb") +
+                  moduleYaml("2", "cccccccc") + moduleYaml("3", "dddddddd"), "test");
+    container.createConflictsBetweenStreams();
+
+    auto modulePackages = container.getModulePackages();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4), modulePackages.size());
+    for (auto modulePackage : modulePackages) {
+        auto conflicts = modulePackage->getConflicts();
+        // every other stream is conflicted once, regardless of the number of its contexts
+        for (const char * stream : {"1", "2", "3"}) {
+            auto conflict = std::string("module(conflicting:") + stream + ")";
+            auto expected = modulePackage->getStream() == stream ? 0 : 1;
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::ptrdiff_t>(expected),
+                                 std::count(conflicts.begin(), conflicts.end(), conflict));
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#include "RepoTest.hpp"
+
+#include "libdnf/dnf-utils.h"
+
+#include <glib.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RepoTest);
+
+void RepoTest::setUp()
+{
+    cachedir = g_dir_make_tmp("libdnf-test-repo-XXXXXX", nullptr);
+    config.cachedir().set(libdnf::Option::Priority::RUNTIME, cachedir);
+}
+
+void RepoTest::tearDown()
+{
+    dnf_remove_recursive(cachedir, nullptr);
+    g_free(cachedir);
+}
+
+std::unique_ptr<libdnf::Repo> RepoTest::createRepo(const std::string & id, const std::string & path)
+{
+    std::unique_ptr<libdnf::ConfigRepo> conf(new libdnf::ConfigRepo(config));
+    conf->baseurl().set(libdnf::Option::Priority::RUNTIME,
+                        std::vector<std::string>{"file://" TESTDATADIR "/modules/modules/" + path});
+    return std::unique_ptr<libdnf::Repo>(new libdnf::Repo(id, std::move(conf)));
+}
+
+void RepoTest::testFetchMetadata()
+{
+    auto httpd = createRepo("httpd", "httpd-2.4-2/x86_64/");
+    auto runtime = createRepo("runtime", "base-runtime-f26-1/x86_64/");
+
+    libdnf::Repo::fetchMetadata({httpd.get(), runtime.get()});
+
+    for (auto repo : {httpd.get(), runtime.get()}) {
+        CPPUNIT_ASSERT(repo->fresh());
+        CPPUNIT_ASSERT(!repo->getMetadataPath("primary").empty());
+        // load() reports the metadata downloaded by the batch as fresh, once
+        CPPUNIT_ASSERT(repo->load());
+        CPPUNIT_ASSERT(!repo->load());
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef LIBDNF_REPOTEST_HPP
+#define LIBDNF_REPOTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "libdnf/conf/ConfigMain.hpp"
+#include "libdnf/repo/Repo.hpp"
+
+class RepoTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(RepoTest);
+        CPPUNIT_TEST(testFetchMetadata);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testFetchMetadata();
+
+private:
+    std::unique_ptr<libdnf::Repo> createRepo(const std::string & id, const std::string & path);
+
+    libdnf::ConfigMain config;
+    char * cachedir;
+};
+
+
+#endif //LIBDNF_REPOTEST_HPP